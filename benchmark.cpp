@@ -0,0 +1,418 @@
+// Benchmark reproducible del motor de almacenamiento (clase Disco).
+//
+// Compilar:  g++ -std=c++17 -O2 benchmark.cpp -o benchmark
+// Ejemplos:
+//   ./benchmark                                   (configuración por defecto)
+//   ./benchmark --filas 5000 --operaciones 2000 --mezcla lectura,escritura,scan
+//   ./benchmark --dataset titanic --geometria 2,4,20,8 --capacidad 512 --capacidad 1024
+//
+// Genera datos sintéticos con la forma de Housing.csv o titanicG.csv, los carga con
+// cargarCSV y ejecuta mezclas de operaciones al estilo YCSB. Por cada configuración y
+// operación escribe una línea JSON (duración, throughput y latencias p50/p99/p999) en el
+// archivo de salida (por defecto bench_output.txt) y un resumen legible en la consola.
+// Los tiempos cubren solo las llamadas al disco, no la generación de las operaciones.
+
+#define DISCO_SIN_MAIN
+#include "config.cpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <filesystem>
+#include <map>
+
+// ---------------------------------------------------------------------------
+// Generador de cargas sintéticas
+// ---------------------------------------------------------------------------
+class GeneradorCargas {
+private:
+    mt19937_64 rng;
+    string dataset;
+    long siguientePasajero;
+
+    // Distribución Zipf (método de Gray et al., usado por YCSB) sobre [0, n)
+    long n_zipf;
+    double theta, zetan, alpha, eta;
+
+    static double zeta(long n, double theta) {
+        double suma = 0;
+        for (long i = 1; i <= n; ++i) suma += 1.0 / pow((double)i, theta);
+        return suma;
+    }
+
+    int entero(int minimo, int maximo) {
+        return uniform_int_distribution<int>(minimo, maximo)(rng);
+    }
+
+    bool probabilidad(double p) {
+        return uniform_real_distribution<double>(0.0, 1.0)(rng) < p;
+    }
+
+    template <size_t N>
+    const char* elegir(const char* const (&opciones)[N]) {
+        return opciones[entero(0, N - 1)];
+    }
+
+public:
+    GeneradorCargas(uint64_t semilla, const string& tipoDataset)
+        : rng(semilla), dataset(tipoDataset), siguientePasajero(1), n_zipf(0),
+          theta(0.99), zetan(0), alpha(0), eta(0) {}
+
+    string esquema() const {
+        if (dataset == "titanic") {
+            return "PassengerId,Survived,Pclass,Name,Sex,Age,SibSp,Parch,Ticket,Fare,Cabin,Embarked";
+        }
+        return "price,area,bedrooms,bathrooms,stories,mainroad,guestroom,basement,hotwaterheating,airconditioning,parking,prefarea,furnishingstatus";
+    }
+
+    // Columna y umbral usados por la operación scan
+    pair<string, string> condicionScan() {
+        if (dataset == "titanic") {
+            return {"Age", to_string(entero(20, 75))};
+        }
+        return {"price", to_string(entero(2000000, 12000000))};
+    }
+
+    // Fila separada por comas con la misma forma que el CSV original
+    string filaCSV() {
+        static const char* const SI_NO[] = {"yes", "no"};
+        static const char* const AMUEBLADO[] = {"furnished", "semi-furnished", "unfurnished"};
+        static const char* const APELLIDOS[] = {"Braund", "Cumings", "Heikkinen", "Futrelle", "Allen", "Moran", "McCarthy", "Palsson"};
+        static const char* const NOMBRES[] = {"Owen", "John", "Laina", "Jacques", "William", "James", "Timothy", "Gosta"};
+        static const char* const PUERTOS[] = {"S", "C", "Q"};
+
+        stringstream ss;
+        if (dataset == "titanic") {
+            bool hombre = probabilidad(0.65);
+            int clase = entero(1, 3);
+            ss << siguientePasajero++ << "," << (probabilidad(0.38) ? 1 : 0) << "," << clase << ","
+               << APELLIDOS[entero(0, 7)] << " " << (hombre ? "Mr. " : "Mrs. ") << NOMBRES[entero(0, 7)] << ","
+               << (hombre ? "male" : "female") << ",";
+            if (probabilidad(0.8)) ss << entero(1, 80);
+            ss << "," << entero(0, 3) << "," << entero(0, 2) << "," << "PC " << entero(10000, 99999) << ","
+               << fixed << setprecision(4) << (clase == 1 ? 30.0 : 5.0) + entero(0, 50000) / 1000.0 << ",";
+            if (clase == 1 && probabilidad(0.7)) ss << (char)('A' + entero(0, 5)) << entero(1, 120);
+            ss << "," << (probabilidad(0.72) ? "S" : elegir(PUERTOS));
+        } else {
+            int area = entero(1650, 16200);
+            ss << 1750000 + (long)area * 300 + entero(0, 3000000) << "," << area << "," << entero(1, 6) << ","
+               << entero(1, 4) << "," << entero(1, 4) << "," << (probabilidad(0.86) ? "yes" : "no") << ","
+               << elegir(SI_NO) << "," << elegir(SI_NO) << "," << (probabilidad(0.05) ? "yes" : "no") << ","
+               << elegir(SI_NO) << "," << entero(0, 3) << "," << (probabilidad(0.23) ? "yes" : "no") << ","
+               << elegir(AMUEBLADO);
+        }
+        return ss.str();
+    }
+
+    // Misma fila en el formato interno del disco ('#' como separador)
+    string filaRegistro() {
+        string fila = filaCSV();
+        replace(fila.begin(), fila.end(), ',', '#');
+        return fila;
+    }
+
+    void configurarZipf(long n) {
+        n_zipf = max(1L, n);
+        zetan = zeta(n_zipf, theta);
+        double zeta2 = zeta(2, theta);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1 - pow(2.0 / n_zipf, 1 - theta)) / (1 - zeta2 / zetan);
+    }
+
+    long zipf() {
+        double u = uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * zetan;
+        if (uz < 1.0) return 0;
+        if (uz < 1.0 + pow(0.5, theta)) return 1;
+        return min(n_zipf - 1, (long)(n_zipf * pow(eta * u - eta + 1, alpha)));
+    }
+
+    long uniforme(long n) {
+        return uniform_int_distribution<long>(0, max(0L, n - 1))(rng);
+    }
+
+    double real01() {
+        return uniform_real_distribution<double>(0.0, 1.0)(rng);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Mezclas de operaciones (porcentajes de get / insert / del / scan)
+// ---------------------------------------------------------------------------
+struct Mezcla {
+    string nombre;
+    double get, insert, del, scan;
+};
+
+const Mezcla MEZCLAS[] = {
+    {"lectura",    0.95, 0.05, 0.00, 0.00}, // YCSB B: mayormente lecturas
+    {"balanceada", 0.50, 0.50, 0.00, 0.00}, // YCSB A
+    {"escritura",  0.10, 0.80, 0.10, 0.00}, // Carga de ingesta
+    {"scan",       0.00, 0.05, 0.00, 0.95}, // YCSB E: scans cortos
+};
+
+// ---------------------------------------------------------------------------
+// Latencias exactas (independientes de DISCO_SIN_METRICAS)
+// ---------------------------------------------------------------------------
+struct Muestras {
+    vector<uint64_t> nanos;
+    uint64_t errores = 0;
+
+    uint64_t percentil(double p) {
+        if (nanos.empty()) return 0;
+        size_t idx = min(nanos.size() - 1, (size_t)(p * nanos.size()));
+        nth_element(nanos.begin(), nanos.begin() + idx, nanos.end());
+        return nanos[idx];
+    }
+
+    uint64_t total() const {
+        return accumulate(nanos.begin(), nanos.end(), (uint64_t)0);
+    }
+};
+
+struct Geometria {
+    int platos, superficies, pistas, sectores;
+};
+
+struct OpcionesBenchmark {
+    long filas = 1000;
+    long operaciones = 1000;
+    string dataset = "housing";
+    string distribucion = "zipf";
+    bool compresion = false;
+    uint64_t semilla = 42;
+    string salida = "bench_output.txt";
+    vector<Geometria> geometrias;
+    vector<int> capacidades;
+    vector<string> mezclas;
+};
+
+template <typename F>
+uint64_t medir(F&& f) {
+    auto inicio = chrono::steady_clock::now();
+    f();
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - inicio).count();
+}
+
+// Geometría con capacidad suficiente para ~3 veces los datos esperados
+Geometria geometriaAutomatica(long filas, long operaciones, int capacidad, const string& dataset) {
+    long bytesPorFila = dataset == "titanic" ? 70 : 60;
+    long sectoresNecesarios = (filas + operaciones) * bytesPorFila * 3 / capacidad + 2;
+    Geometria g = {2, 4, 1, 16};
+    long porPista = (long)g.platos * g.superficies * g.sectores;
+    g.pistas = (int)max(1L, (sectoresNecesarios + porPista - 1) / porPista);
+    return g;
+}
+
+string etiquetaGeometria(const Geometria& g) {
+    return to_string(g.platos) + "x" + to_string(g.superficies) + "x" + to_string(g.pistas) + "x" + to_string(g.sectores);
+}
+
+// 'nanosFase' es el tiempo medido de las operaciones de la línea. Con opsSinLatencias >= 0
+// solo se conoce ese total para 'opsSinLatencias' operaciones (ej. las filas de una carga):
+// se reportan la duración y el throughput, y las latencias quedan en null.
+void reportar(ofstream& salida, const OpcionesBenchmark& opc, const Geometria& g, int capacidad,
+              const string& fase, const string& operacion, Muestras& m, uint64_t nanosFase,
+              long opsSinLatencias = -1) {
+    bool conLatencias = opsSinLatencias < 0;
+    size_t n = conLatencias ? m.nanos.size() : opsSinLatencias;
+    double segundos = nanosFase / 1e9;
+    double opsPorSeg = segundos > 0 ? n / segundos : 0;
+    uint64_t p50 = m.percentil(0.50), p99 = m.percentil(0.99), p999 = m.percentil(0.999);
+    auto latencia = [&](uint64_t nanos) {
+        stringstream ss;
+        if (conLatencias) ss << fixed << setprecision(1) << nanos / 1000.0;
+        else ss << "null";
+        return ss.str();
+    };
+
+    salida << "{\"dataset\": \"" << opc.dataset << "\", \"geometria\": \"" << etiquetaGeometria(g)
+           << "\", \"capacidad_sector\": " << capacidad << ", \"compresion\": " << (opc.compresion ? "true" : "false")
+           << ", \"filas\": " << opc.filas << ", \"distribucion\": \"" << opc.distribucion
+           << "\", \"fase\": \"" << fase << "\", \"operacion\": \"" << operacion
+           << "\", \"ops\": " << n << ", \"errores\": " << m.errores
+           << fixed << setprecision(3) << ", \"duracion_ms\": " << nanosFase / 1e6
+           << setprecision(1) << ", \"ops_por_seg\": " << opsPorSeg
+           << ", \"p50_us\": " << latencia(p50) << ", \"p99_us\": " << latencia(p99)
+           << ", \"p999_us\": " << latencia(p999) << "}\n";
+    salida.unsetf(ios::fixed);
+
+    cout << left << setw(12) << fase << setw(20) << operacion << right << setw(8) << n
+         << fixed << setprecision(1) << setw(12) << nanosFase / 1e6 << setw(12) << opsPorSeg << setw(12) << (conLatencias ? latencia(p50) : "-")
+         << setw(12) << (conLatencias ? latencia(p99) : "-") << setw(12) << (conLatencias ? latencia(p999) : "-") << "\n";
+    cout.unsetf(ios::fixed);
+}
+
+void ejecutarConfiguracion(const OpcionesBenchmark& opc, const Geometria& g, int capacidad, ofstream& salida) {
+    string nombreDisco = "bench_" + etiquetaGeometria(g) + "_" + to_string(capacidad);
+    string rutaDisco = "./" + nombreDisco + "_disk";
+    string rutaCSV = nombreDisco + ".csv";
+    filesystem::remove_all(rutaDisco);
+
+    cout << "\n=== " << opc.dataset << " | geometría " << etiquetaGeometria(g) << " | sector " << capacidad
+         << " B | " << opc.filas << " filas | " << opc.distribucion << " ===\n";
+    cout << left << setw(12) << "Fase" << setw(20) << "Operación" << right << setw(8) << "Ops"
+         << setw(12) << "ms" << setw(12) << "ops/s" << setw(12) << "p50(us)" << setw(12) << "p99(us)" << setw(12) << "p999(us)" << "\n";
+
+    GeneradorCargas gen(opc.semilla, opc.dataset);
+    {
+        ofstream csv(rutaCSV, ios::trunc);
+        csv << gen.esquema() << "\n";
+        for (long i = 0; i < opc.filas; ++i) csv << gen.filaCSV() << "\n";
+    }
+
+    Disco* disco = new Disco(g.platos, g.superficies, g.pistas, g.sectores, capacidad, nombreDisco,
+                             opc.compresion ? COMPRESION_DICCIONARIO : COMPRESION_NINGUNA);
+    disco->setSilencioso(true);
+
+    // Fase de carga: una sola llamada a cargarCSV, que no mide sus filas una a una. Se
+    // reporta su duración y el throughput por fila, sin percentiles.
+    Muestras carga;
+    uint64_t nanosCarga = medir([&] { disco->cargarCSV(rutaCSV); });
+    reportar(salida, opc, g, capacidad, "carga", "cargarCSV", carga, nanosCarga, opc.filas);
+
+    // IDs vivos: cargarCSV asigna IDs consecutivos desde 1
+    vector<long> vivos;
+    for (long id = 1; id <= opc.filas; ++id) vivos.push_back(id);
+    long siguienteId = opc.filas + 1;
+
+    for (const string& nombreMezcla : opc.mezclas) {
+        const Mezcla* mezcla = nullptr;
+        for (const auto& m : MEZCLAS) {
+            if (m.nombre == nombreMezcla) mezcla = &m;
+        }
+        if (!mezcla) {
+            cerr << "Mezcla desconocida: " << nombreMezcla << endl;
+            continue;
+        }
+
+        map<string, Muestras> muestras;
+        gen.configurarZipf((long)vivos.size());
+        for (long i = 0; i < opc.operaciones; ++i) {
+            double r = gen.real01();
+            if (r < mezcla->get && !vivos.empty()) {
+                long pos = opc.distribucion == "zipf" ? min((long)vivos.size() - 1, gen.zipf()) : gen.uniforme(vivos.size());
+                long id = vivos[vivos.size() - 1 - pos]; // Los más recientes son los más populares
+                string registro;
+                muestras["recuperarRegistro"].nanos.push_back(medir([&] { registro = disco->recuperarRegistro(id); }));
+                if (registro.empty()) muestras["recuperarRegistro"].errores++;
+            } else if (r < mezcla->get + mezcla->insert) {
+                string fila = gen.filaRegistro();
+                bool ok = false;
+                muestras["insertarRegistro"].nanos.push_back(medir([&] { ok = disco->insertarRegistro(fila); }));
+                if (ok) {
+                    vivos.push_back(siguienteId++);
+                } else {
+                    muestras["insertarRegistro"].errores++;
+                }
+            } else if (r < mezcla->get + mezcla->insert + mezcla->del && !vivos.empty()) {
+                size_t pos = gen.uniforme(vivos.size());
+                long id = vivos[pos];
+                bool ok = false;
+                muestras["eliminarRegistro"].nanos.push_back(medir([&] { ok = disco->eliminarRegistro(id); }));
+                if (ok) {
+                    vivos[pos] = vivos.back();
+                    vivos.pop_back();
+                } else {
+                    muestras["eliminarRegistro"].errores++;
+                }
+            } else {
+                auto [columna, umbral] = gen.condicionScan();
+                int leidos, descartados;
+                muestras["escanearPorValor"].nanos.push_back(
+                    medir([&] { disco->escanearPorValor(columna, ">", umbral, leidos, descartados); }));
+            }
+        }
+        Muestras todas;
+        for (auto& [op, m] : muestras) {
+            reportar(salida, opc, g, capacidad, mezcla->nombre, op, m, m.total());
+            todas.nanos.insert(todas.nanos.end(), m.nanos.begin(), m.nanos.end());
+            todas.errores += m.errores;
+        }
+        // Suma de las operaciones medidas: sin el costo del generador ni de la contabilidad
+        reportar(salida, opc, g, capacidad, mezcla->nombre, "total", todas, todas.total());
+    }
+
+    delete disco;
+    filesystem::remove_all(rutaDisco);
+    filesystem::remove(rutaCSV);
+}
+
+void mostrarAyuda() {
+    cout << "Uso: benchmark [opciones]\n"
+         << "  --filas N              Filas sintéticas cargadas con cargarCSV (def. 1000)\n"
+         << "  --operaciones N        Operaciones por mezcla (def. 1000)\n"
+         << "  --dataset housing|titanic\n"
+         << "  --mezcla a,b,...       lectura, balanceada, escritura, scan (def. todas)\n"
+         << "  --distribucion zipf|uniforme   Popularidad de las claves (def. zipf)\n"
+         << "  --geometria P,S,T,Sec  Platos, superficies, pistas y sectores (repetible)\n"
+         << "  --capacidad BYTES      Capacidad de sector (repetible, def. 512)\n"
+         << "  --compresion           Usar compresión por diccionario\n"
+         << "  --semilla N            Semilla del generador (def. 42)\n"
+         << "  --salida ARCHIVO       Resultados en JSON por línea (def. bench_output.txt)\n";
+}
+
+int main(int argc, char** argv) {
+    OpcionesBenchmark opc;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        auto siguiente = [&]() -> string {
+            if (i + 1 >= argc) {
+                cerr << "Falta el valor de " << arg << endl;
+                exit(1);
+            }
+            return argv[++i];
+        };
+        if (arg == "--filas") opc.filas = stol(siguiente());
+        else if (arg == "--operaciones") opc.operaciones = stol(siguiente());
+        else if (arg == "--dataset") opc.dataset = siguiente();
+        else if (arg == "--distribucion") opc.distribucion = siguiente();
+        else if (arg == "--compresion") opc.compresion = true;
+        else if (arg == "--semilla") opc.semilla = stoull(siguiente());
+        else if (arg == "--salida") opc.salida = siguiente();
+        else if (arg == "--capacidad") opc.capacidades.push_back(stoi(siguiente()));
+        else if (arg == "--mezcla") {
+            stringstream ss(siguiente());
+            string m;
+            while (getline(ss, m, ',')) opc.mezclas.push_back(m);
+        } else if (arg == "--geometria") {
+            Geometria g;
+            char c;
+            stringstream ss(siguiente());
+            if (!(ss >> g.platos >> c >> g.superficies >> c >> g.pistas >> c >> g.sectores)) {
+                cerr << "Geometría inválida, use P,S,T,Sec" << endl;
+                return 1;
+            }
+            opc.geometrias.push_back(g);
+        } else if (arg == "--ayuda" || arg == "-h") {
+            mostrarAyuda();
+            return 0;
+        } else {
+            cerr << "Opción desconocida: " << arg << endl;
+            mostrarAyuda();
+            return 1;
+        }
+    }
+    if (opc.capacidades.empty()) opc.capacidades.push_back(512);
+    if (opc.mezclas.empty()) {
+        for (const auto& m : MEZCLAS) opc.mezclas.push_back(m.nombre);
+    }
+
+    ofstream salida(opc.salida, ios::app);
+    if (!salida.is_open()) {
+        cerr << "Error: No se pudo abrir " << opc.salida << endl;
+        return 1;
+    }
+
+    for (int capacidad : opc.capacidades) {
+        vector<Geometria> geometrias = opc.geometrias;
+        if (geometrias.empty()) {
+            geometrias.push_back(geometriaAutomatica(opc.filas, opc.operaciones * (long)opc.mezclas.size(), capacidad, opc.dataset));
+        }
+        for (const Geometria& g : geometrias) {
+            ejecutarConfiguracion(opc, g, capacidad, salida);
+        }
+    }
+    cout << "\nResultados agregados a " << opc.salida << endl;
+    return 0;
+}
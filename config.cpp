@@ -10,17 +10,91 @@
 #include <sstream>
 #include <numeric>
 #include <limits> // Para numeric_limits
+#include <tuple>
+#include <unordered_map>
+#include <chrono> // Para medir tiempos en el reporte de compresión
+#include <cstdint>
+#include <functional> // Para std::hash
+#include <atomic>
+#include <queue> // Para la fusión k-way de la carga ordenada
+#include <thread>
+#include <mutex>
+#include <list> // LRU de shards del diccionario
+#include <condition_variable>
+#include <deque>
+#include <memory> // shared_ptr de los grupos del sort-merge join
+#include <cerrno>
+#include <cmath>
 
 #ifdef _WIN32
 #include <direct.h> 
 #define MKDIR(path) _mkdir(path)
+#define RMDIR(path) _rmdir(path)
 #else
 #include <unistd.h> // Para mkdir en sistemas Unix/Linux
+#include <fcntl.h>
+#include <sys/mman.h> // mmap de los shards del diccionario
 #define MKDIR(path) mkdir(path, 0777) // 0777 para permisos rwx para todos
+#define RMDIR(path) rmdir(path)
 #endif
 
 using namespace std;
 
+// Fragmento de un registro dentro de un sector (usado por registros que ocupan varios sectores)
+struct Extension {
+    int platoIdx;
+    int superficieIdx;
+    int pistaIdx;
+    int sectorGlobalEnPista;
+    long offset;
+    int tam; // Incluye el '\n' que termina cada fragmento
+};
+
+// Tamaño mínimo de un fragmento (datos + '\n'): colas más pequeñas no se aprovechan
+const int TAM_MIN_FRAGMENTO = 8;
+
+// Los fragmentos de un registro repartido, salvo el primero, empiezan con la cabecera
+// "\x1E<lba>:<offset>:<posición>:<total>\x1E": ubicación del primer fragmento, posición de
+// sus datos dentro del registro y bytes totales. Así fsck puede reencadenarlos solo con el
+// contenido de los sectores. Los campos van con ceros a la izquierda para que el largo de
+// la cabecera se conozca antes de repartir el registro.
+const char MARCA_CONTINUACION = '\x1E';
+
+struct CabeceraContinuacion {
+    long lbaPrimero = 0;
+    long offsetPrimero = 0;
+    long posicion = 0;
+    long total = 0;
+};
+
+int cifrasDecimales(long n) {
+    int cifras = 1;
+    while (n >= 10) {
+        n /= 10;
+        cifras++;
+    }
+    return cifras;
+}
+
+// Lee la cabecera de continuación de texto[inicio, fin); devuelve su largo o 0 si no hay
+size_t leerCabeceraContinuacion(const string& texto, size_t inicio, size_t fin, CabeceraContinuacion& cabecera) {
+    if (inicio >= fin || texto[inicio] != MARCA_CONTINUACION) return 0;
+    long campos[4];
+    size_t pos = inicio + 1;
+    for (int c = 0; c < 4; ++c) {
+        long valor = 0;
+        size_t desde = pos;
+        while (pos < fin && pos - desde < 18 && isdigit((unsigned char)texto[pos])) valor = valor * 10 + (texto[pos++] - '0');
+        char separador = c < 3 ? ':' : MARCA_CONTINUACION;
+        if (pos == desde || pos >= fin || texto[pos] != separador) return 0;
+        campos[c] = valor;
+        pos++;
+    }
+    if (campos[2] <= 0 || campos[2] >= campos[3]) return 0;
+    cabecera = {campos[0], campos[1], campos[2], campos[3]};
+    return pos - inicio;
+}
+
 // Estructura para almacenar los metadatos de un registro
 struct RecordMetadata {
     long idRegistro;
@@ -31,8 +105,399 @@ struct RecordMetadata {
     long offset; 
     int tamRegistro; 
     bool ocupado; 
+    // Fragmentos siguientes si el registro no cupo en un solo sector. Los campos de
+    // ubicación anteriores describen el primer fragmento.
+    vector<Extension> extensiones;
+};
+
+// Modos de compresión soportados por el disco (se guardan en la línea CONFIG)
+const string COMPRESION_NINGUNA = "NONE";
+const string COMPRESION_DICCIONARIO = "DICT";
+
+// Marca que indica que un campo fue reemplazado por un índice del diccionario de valores.
+// Un campo original que empiece con la marca se escapa duplicándola ("@@...").
+const char MARCA_DICCIONARIO = '@';
+const int UMBRAL_CATEGORICO = 32;        // Máximo de valores distintos para considerar una columna categórica
+const int MAX_VALORES_DICCIONARIO = 4096; // Límite de entradas del diccionario de valores
+
+// Carga ordenada (ordenamiento externo)
+const size_t MEMORIA_ORDENAMIENTO_DEFECTO = 4 * 1024 * 1024; // Bytes de registros por corrida en RAM
+const size_t MAX_CORRIDAS_FUSION = 16;                       // Archivos abiertos a la vez al fusionar
+
+// Join entre tablas
+const int MAX_PARTICIONES_JOIN = 64;         // Particiones del grace hash join (2 archivos abiertos por partición)
+const int MAX_NIVELES_JOIN = 4;              // Veces que se vuelve a particionar una partición demasiado grande
+const size_t TAM_LOTE_JOIN = 256 * 1024;     // Bytes del lado de sondeo que se reparten entre hilos a la vez
+const size_t FILAS_POR_ENTREGA_JOIN = 256;   // Filas que un hilo acumula antes de tomar el mutex de salida
+
+// Resumen de una columna dentro de un sector (zone map): min/max de los valores
+// numéricos y un filtro de Bloom de 64 bits con todos los valores no vacíos
+// (normalizados con claveIgualdad, así "3" y "3.0" tienen los mismos bits).
+struct ResumenColumna {
+    bool tieneTexto = false;   // Se vio al menos un valor no vacío y no numérico
+    bool tieneNumeros = false; // Se vio al menos un valor numérico
+    double minimo = 0;
+    double maximo = 0;
+    uint64_t bloom = 0;
+};
+
+// Zone map de un sector: resumen por columna de los registros escritos en él.
+// No se actualiza al eliminar, por lo que es conservador (puede incluir valores borrados).
+struct ZonaSector {
+    int numRegistros = 0;
+    vector<ResumenColumna> columnas;
+};
+
+const int BLOOM_NUM_HASHES = 3;
+
+// Bits del filtro de Bloom para un valor (doble hashing: h1 + i*h2)
+uint64_t bitsBloom(const string& valor) {
+    size_t h1 = hash<string>{}(valor);
+    size_t h2 = (h1 >> 17) | 1;
+    uint64_t bits = 0;
+    for (int i = 0; i < BLOOM_NUM_HASHES; ++i) {
+        bits |= 1ULL << ((h1 + i * h2) % 64);
+    }
+    return bits;
+}
+
+// Divide una línea por '#' conservando los campos vacíos (incluido el último)
+vector<string> dividirCampos(const string& linea) {
+    vector<string> campos;
+    size_t inicio = 0;
+    while (true) {
+        size_t pos = linea.find('#', inicio);
+        if (pos == string::npos) {
+            campos.push_back(linea.substr(inicio));
+            break;
+        }
+        campos.push_back(linea.substr(inicio, pos - inicio));
+        inicio = pos + 1;
+    }
+    return campos;
+}
+
+// Valor de la columna 'columna' de un registro ("" si el registro tiene menos campos)
+string campoEn(const string& registro, int columna) {
+    vector<string> campos = dividirCampos(registro);
+    return columna < (int)campos.size() ? campos[columna] : "";
+}
+
+// Indica si un campo es numérico (entero o decimal, con exponente opcional). No acepta
+// espacios, hexadecimal, "nan"/"inf" ni valores fuera del rango de double.
+bool esNumerico(const string& valor) {
+    if (valor.empty() || valor.find_first_not_of("0123456789+-.eE") != string::npos) return false;
+    char* fin = nullptr;
+    errno = 0;
+    double v = strtod(valor.c_str(), &fin);
+    return fin != nullptr && *fin == '\0' && errno != ERANGE && isfinite(v);
+}
+
+// Clave de ordenamiento de un valor de columna. Orden total: vacíos, luego números
+// (por valor) y luego texto, para que sort y la fusión de corridas sean consistentes.
+struct ClaveOrden {
+    int clase; // 0 = vacío, 1 = numérico, 2 = texto
+    double numero;
+    string texto;
+
+    explicit ClaveOrden(double valor) : clase(1), numero(valor) {}
+
+    explicit ClaveOrden(const string& valor) : clase(2), numero(0), texto(valor) {
+        if (valor.empty()) {
+            clase = 0;
+        } else if (esNumerico(valor)) {
+            clase = 1;
+            numero = stod(valor);
+        }
+    }
+
+    bool operator<(const ClaveOrden& otra) const {
+        if (clase != otra.clase) return clase < otra.clase;
+        if (clase == 1) return numero < otra.numero;
+        return texto < otra.texto;
+    }
+};
+
+// Compara dos valores con el orden de ClaveOrden (-1, 0 o 1)
+int compararValores(const ClaveOrden& a, const ClaveOrden& b) {
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+// Resultado de "a operador b" a partir de compararValores(a, b)
+bool cumpleOperador(int cmp, const string& operador) {
+    if (operador == "=")  return cmp == 0;
+    if (operador == "!=") return cmp != 0;
+    if (operador == ">")  return cmp > 0;
+    if (operador == ">=") return cmp >= 0;
+    if (operador == "<")  return cmp < 0;
+    if (operador == "<=") return cmp <= 0;
+    return false;
+}
+
+// Clave de igualdad para el hash join: los números se comparan por valor ("3" == "3.0"),
+// igual que en ClaveOrden, para que ambos algoritmos de join den el mismo resultado.
+string claveIgualdad(const string& valor) {
+    if (!esNumerico(valor)) return valor;
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.17g", stod(valor));
+    return buffer;
+}
+
+// Valores distintos de las columnas que podrían codificarse con el diccionario de
+// valores (no numéricas y con pocos valores distintos). Se alimenta registro a registro.
+struct ValoresCategoricos {
+    vector<vector<string>> distintosPorColumna;
+    vector<bool> descartada;
+
+    void observar(const string& registro) {
+        vector<string> campos = dividirCampos(registro);
+        if (campos.size() > distintosPorColumna.size()) {
+            distintosPorColumna.resize(campos.size());
+            descartada.resize(campos.size(), false);
+        }
+        for (size_t c = 0; c < campos.size(); ++c) {
+            if (descartada[c] || campos[c].empty()) continue;
+            if (esNumerico(campos[c])) {
+                descartada[c] = true; // Las columnas numéricas no se codifican
+                continue;
+            }
+            vector<string>& distintos = distintosPorColumna[c];
+            if (find(distintos.begin(), distintos.end(), campos[c]) == distintos.end()) {
+                distintos.push_back(campos[c]);
+                if ((int)distintos.size() > UMBRAL_CATEGORICO) {
+                    descartada[c] = true; // Demasiados valores distintos (ej. nombres)
+                }
+            }
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Métricas de operaciones e I/O. Compilar con -DDISCO_SIN_METRICAS para
+// eliminarlas por completo (las macros METRICA_* quedan vacías).
+// ---------------------------------------------------------------------------
+#ifndef DISCO_SIN_METRICAS
+
+enum OperacionMetrica {
+    OP_INSERTAR,
+    OP_RECUPERAR,
+    OP_ELIMINAR,
+    OP_CARGAR_CSV,
+    OP_ESCANEAR,
+    OP_BUSCAR_ESPACIO,
+    OP_PERSISTIR_DICCIONARIO,
+    OP_SECTOR_ESCRIBIR,
+    OP_SECTOR_LEER,
+    OP_CARGAR_ORDENADO,
+    OP_UNIR,
+    OP_VERIFICAR,
+    NUM_OPERACIONES
+};
+
+const char* const NOMBRES_OPERACIONES[NUM_OPERACIONES] = {
+    "insertarRegistro",
+    "recuperarRegistro",
+    "eliminarRegistro",
+    "cargarCSV",
+    "escanearPorValor",
+    "encontrarEspacioCilindrico",
+    "persistirDiccionario",
+    "Sector::escribir",
+    "Sector::leer",
+    "cargarCSVOrdenado",
+    "unirTablas",
+    "verificarDisco"
+};
+
+// Histograma de latencias con cubetas logarítmicas: la cubeta i cuenta las
+// mediciones en [2^i, 2^(i+1)) nanosegundos.
+struct HistogramaLatencia {
+    static const int NUM_CUBETAS = 48;
+    atomic<uint64_t> cubetas[NUM_CUBETAS];
+    atomic<uint64_t> cuenta;
+    atomic<uint64_t> sumaNanos;
+    atomic<uint64_t> maxNanos;
+
+    HistogramaLatencia() { reiniciar(); }
+
+    void reiniciar() {
+        for (auto& c : cubetas) c.store(0, memory_order_relaxed);
+        cuenta.store(0, memory_order_relaxed);
+        sumaNanos.store(0, memory_order_relaxed);
+        maxNanos.store(0, memory_order_relaxed);
+    }
+
+    static int cubetaPara(uint64_t nanos) {
+        int i = 0;
+        while (nanos > 1 && i < NUM_CUBETAS - 1) {
+            nanos >>= 1;
+            i++;
+        }
+        return i;
+    }
+
+    // Límite superior (exclusivo) de la cubeta i, en nanosegundos
+    static uint64_t limiteCubeta(int i) {
+        return 1ULL << (i + 1);
+    }
+
+    void registrar(uint64_t nanos) {
+        cubetas[cubetaPara(nanos)].fetch_add(1, memory_order_relaxed);
+        cuenta.fetch_add(1, memory_order_relaxed);
+        sumaNanos.fetch_add(nanos, memory_order_relaxed);
+        uint64_t actual = maxNanos.load(memory_order_relaxed);
+        while (nanos > actual && !maxNanos.compare_exchange_weak(actual, nanos, memory_order_relaxed)) {
+        }
+    }
+
+    // Percentil aproximado (límite superior de la cubeta que lo contiene)
+    uint64_t percentil(double p) const {
+        uint64_t total = cuenta.load(memory_order_relaxed);
+        if (total == 0) return 0;
+        uint64_t objetivo = (uint64_t)(p * total);
+        if (objetivo >= total) objetivo = total - 1;
+        uint64_t acumulado = 0;
+        for (int i = 0; i < NUM_CUBETAS; ++i) {
+            acumulado += cubetas[i].load(memory_order_relaxed);
+            if (acumulado > objetivo) {
+                return min(limiteCubeta(i), maxNanos.load(memory_order_relaxed));
+            }
+        }
+        return maxNanos.load(memory_order_relaxed);
+    }
+};
+
+class Metricas {
+public:
+    HistogramaLatencia latencias[NUM_OPERACIONES];
+    atomic<uint64_t> bytesLeidos{0};
+    atomic<uint64_t> bytesEscritos{0};
+    atomic<uint64_t> archivosAbiertos{0};
+    atomic<uint64_t> sectoresSondeados{0}; // Sectores examinados al buscar espacio
+    atomic<uint64_t> asignaciones{0};      // Llamadas a encontrarEspacioCilindrico
+
+    void reiniciar() {
+        for (auto& h : latencias) h.reiniciar();
+        bytesLeidos = 0;
+        bytesEscritos = 0;
+        archivosAbiertos = 0;
+        sectoresSondeados = 0;
+        asignaciones = 0;
+    }
+
+    void mostrar(ostream& out) const {
+        out << "\n--- Métricas de Operaciones ---\n";
+        out << left << setw(28) << "Operación" << right << setw(10) << "Cuenta" << setw(12) << "Media(us)"
+            << setw(12) << "p50(us)" << setw(12) << "p99(us)" << setw(12) << "p999(us)" << setw(12) << "Max(us)" << "\n";
+        out << string(98, '-') << "\n";
+        out << fixed << setprecision(1);
+        for (int op = 0; op < NUM_OPERACIONES; ++op) {
+            const HistogramaLatencia& h = latencias[op];
+            uint64_t n = h.cuenta.load();
+            if (n == 0) continue;
+            out << left << setw(28) << NOMBRES_OPERACIONES[op] << right << setw(10) << n
+                << setw(12) << h.sumaNanos.load() / 1000.0 / n
+                << setw(12) << h.percentil(0.50) / 1000.0
+                << setw(12) << h.percentil(0.99) / 1000.0
+                << setw(12) << h.percentil(0.999) / 1000.0
+                << setw(12) << h.maxNanos.load() / 1000.0 << "\n";
+        }
+        out.unsetf(ios::fixed);
+        out << setprecision(6);
+        out << "Bytes leídos: " << bytesLeidos << "  Bytes escritos: " << bytesEscritos
+            << "  Archivos abiertos: " << archivosAbiertos << "\n";
+        uint64_t nAsig = asignaciones.load();
+        out << "Sectores sondeados por asignación: "
+            << (nAsig > 0 ? (double)sectoresSondeados.load() / nAsig : 0.0)
+            << " (" << sectoresSondeados << " en " << nAsig << " asignaciones)\n";
+        out << "-------------------------------\n";
+    }
+
+    bool exportarJSON(const string& ruta) const {
+        ofstream out(ruta, ios::trunc);
+        if (!out.is_open()) return false;
+        out << "{\n  \"operaciones\": {\n";
+        bool primero = true;
+        for (int op = 0; op < NUM_OPERACIONES; ++op) {
+            const HistogramaLatencia& h = latencias[op];
+            if (!primero) out << ",\n";
+            primero = false;
+            out << "    \"" << NOMBRES_OPERACIONES[op] << "\": {\"cuenta\": " << h.cuenta
+                << ", \"suma_ns\": " << h.sumaNanos << ", \"max_ns\": " << h.maxNanos
+                << ", \"p50_ns\": " << h.percentil(0.50) << ", \"p99_ns\": " << h.percentil(0.99)
+                << ", \"p999_ns\": " << h.percentil(0.999) << ", \"cubetas\": [";
+            for (int i = 0; i < HistogramaLatencia::NUM_CUBETAS; ++i) {
+                out << (i ? ", " : "") << h.cubetas[i];
+            }
+            out << "]}";
+        }
+        out << "\n  },\n  \"contadores\": {"
+            << "\"bytes_leidos\": " << bytesLeidos
+            << ", \"bytes_escritos\": " << bytesEscritos
+            << ", \"archivos_abiertos\": " << archivosAbiertos
+            << ", \"sectores_sondeados\": " << sectoresSondeados
+            << ", \"asignaciones\": " << asignaciones << "}\n}\n";
+        return true;
+    }
+
+    // Formato de exposición de texto de Prometheus
+    bool exportarPrometheus(const string& ruta) const {
+        ofstream out(ruta, ios::trunc);
+        if (!out.is_open()) return false;
+        out << "# HELP disco_operacion_latencia_ns Latencia de operaciones del disco en nanosegundos.\n";
+        out << "# TYPE disco_operacion_latencia_ns histogram\n";
+        for (int op = 0; op < NUM_OPERACIONES; ++op) {
+            const HistogramaLatencia& h = latencias[op];
+            uint64_t acumulado = 0;
+            for (int i = 0; i < HistogramaLatencia::NUM_CUBETAS; ++i) {
+                acumulado += h.cubetas[i];
+                out << "disco_operacion_latencia_ns_bucket{op=\"" << NOMBRES_OPERACIONES[op]
+                    << "\",le=\"" << HistogramaLatencia::limiteCubeta(i) << "\"} " << acumulado << "\n";
+            }
+            out << "disco_operacion_latencia_ns_bucket{op=\"" << NOMBRES_OPERACIONES[op] << "\",le=\"+Inf\"} " << h.cuenta << "\n";
+            out << "disco_operacion_latencia_ns_sum{op=\"" << NOMBRES_OPERACIONES[op] << "\"} " << h.sumaNanos << "\n";
+            out << "disco_operacion_latencia_ns_count{op=\"" << NOMBRES_OPERACIONES[op] << "\"} " << h.cuenta << "\n";
+        }
+        out << "# TYPE disco_bytes_leidos_total counter\ndisco_bytes_leidos_total " << bytesLeidos << "\n";
+        out << "# TYPE disco_bytes_escritos_total counter\ndisco_bytes_escritos_total " << bytesEscritos << "\n";
+        out << "# TYPE disco_archivos_abiertos_total counter\ndisco_archivos_abiertos_total " << archivosAbiertos << "\n";
+        out << "# TYPE disco_sectores_sondeados_total counter\ndisco_sectores_sondeados_total " << sectoresSondeados << "\n";
+        out << "# TYPE disco_asignaciones_total counter\ndisco_asignaciones_total " << asignaciones << "\n";
+        return true;
+    }
+};
+
+Metricas& metricas() {
+    static Metricas instancia;
+    return instancia;
+}
+
+// Mide la duración del ámbito en el que se declara y la registra al destruirse
+class MedidorLatencia {
+private:
+    OperacionMetrica operacion;
+    chrono::steady_clock::time_point inicio;
+
+public:
+    explicit MedidorLatencia(OperacionMetrica op) : operacion(op), inicio(chrono::steady_clock::now()) {}
+    ~MedidorLatencia() {
+        auto nanos = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - inicio).count();
+        metricas().latencias[operacion].registrar(nanos);
+    }
 };
 
+#define METRICA_CONCAT_(a, b) a##b
+#define METRICA_CONCAT(a, b) METRICA_CONCAT_(a, b)
+#define METRICA_MEDIR(op) MedidorLatencia METRICA_CONCAT(medidor_, __LINE__)(op)
+#define METRICA_SUMAR(contador, n) metricas().contador.fetch_add((n), memory_order_relaxed)
+
+#else
+
+#define METRICA_MEDIR(op) ((void)0)
+#define METRICA_SUMAR(contador, n) ((void)0)
+
+#endif // DISCO_SIN_METRICAS
+
 // Clase para un Sector en el disco
 class Sector {
 private:
@@ -49,6 +514,7 @@ public:
     long obtenerTamArchivo() {
         FILE* f = fopen(rutaArchivo.c_str(), "rb");
         if (!f) return 0; // Archivo vacío o no existe aún
+        METRICA_SUMAR(archivosAbiertos, 1);
         fseek(f, 0, SEEK_END);
         long size = ftell(f);
         fclose(f);
@@ -57,11 +523,14 @@ public:
 
     // Escribir datos en el sector (modo append). NO AÑADE SALTO DE LÍNEA.
     bool escribir(const string& datos) {
+        METRICA_MEDIR(OP_SECTOR_ESCRIBIR);
         ofstream archivo(rutaArchivo, ios::app);
         if (!archivo.is_open()) {
             cerr << "Error: No se pudo abrir el sector para escribir: " << rutaArchivo << endl;
             return false;
         }
+        METRICA_SUMAR(archivosAbiertos, 1);
+        METRICA_SUMAR(bytesEscritos, datos.size());
         archivo << datos; // Escribe los datos exactamente como vienen
         archivo.close();
         return true;
@@ -70,11 +539,14 @@ public:
     // Sobrecarga de escribir para sobrescribir el contenido (útil para el diccionario)
     bool escribir(const string& datos, bool sobrescribir) {
         if (sobrescribir) {
+            METRICA_MEDIR(OP_SECTOR_ESCRIBIR);
             ofstream archivo(rutaArchivo, ios::trunc); // Abrir en modo truncar para sobrescribir
             if (!archivo.is_open()) {
                 cerr << "Error: No se pudo abrir el sector para sobrescribir: " << rutaArchivo << endl;
                 return false;
             }
+            METRICA_SUMAR(archivosAbiertos, 1);
+            METRICA_SUMAR(bytesEscritos, datos.size());
             archivo << datos;
             archivo.close();
             return true;
@@ -83,26 +555,39 @@ public:
         }
     }
 
+    // Recorta el sector a sus primeros 'tam' bytes (deshace lo añadido al final)
+    bool truncar(long tam) {
+        string contenido = leerTodo();
+        if ((long)contenido.size() <= tam) return true;
+        return escribir(contenido.substr(0, tam), true);
+    }
+
     // Leer todo el contenido del sector
     string leerTodo() {
+        METRICA_MEDIR(OP_SECTOR_LEER);
         ifstream archivo(rutaArchivo);
         if (!archivo.is_open()) {
             return ""; // O lanza una excepción, según el manejo de errores deseado
         }
+        METRICA_SUMAR(archivosAbiertos, 1);
         stringstream buffer;
         buffer << archivo.rdbuf();
+        METRICA_SUMAR(bytesLeidos, buffer.str().size());
         return buffer.str();
     }
 
     // Leer una parte específica del sector
     string leer(long offset, int tamano) {
+        METRICA_MEDIR(OP_SECTOR_LEER);
         ifstream archivo(rutaArchivo);
         if (!archivo.is_open()) {
             return "";
         }
+        METRICA_SUMAR(archivosAbiertos, 1);
         archivo.seekg(offset);
         char* buffer = new char[tamano + 1];
         archivo.read(buffer, tamano);
+        METRICA_SUMAR(bytesLeidos, archivo.gcount());
         buffer[tamano] = '\0'; // Asegurar terminación nula
         string resultado(buffer);
         delete[] buffer;
@@ -242,238 +727,2162 @@ public:
     }
 };
 
-// Clase principal para el Disco
-class Disco {
-private:
-    string nombreDisco;
-    int numPlatos;
-    int numSuperficiesPorPlato;
-    int numPistasPorSuperficie;
-    int numSectoresPorPista;
-    int capacidadSectorBytes;
-    vector<Plato*> platos;
-    string rutaBaseDisco; 
-
-    string tablaEsquema; // Esquema de la tabla, ej: "id#nombre#edad"
-    vector<RecordMetadata> diccionarioDeDatosEnRAM; // Diccionario de datos en RAM
-
-    // Propiedades de la última posición escrita para optimizar la búsqueda secuencial
-    int lastPlatoWritten;
-    int lastSuperficieWritten;
-    int lastPistaWritten;
-    int lastSectorWritten;
+// ---------------------------------------------------------------------------
+// Diccionario de datos paginado. Cada registro es una entrada empaquetada de 13
+// bytes dentro de un shard: un archivo binario <disco>/diccionario/T<tabla>_S<n>.bin
+// con ENTRADAS_POR_SHARD entradas. El registro con ID i de una tabla está en el
+// shard (i-1)/ENTRADAS_POR_SHARD, posición (i-1)%ENTRADAS_POR_SHARD. Los shards se
+// mapean a memoria (mmap) solo al usarse y se desalojan en orden LRU cuando los
+// residentes superan un presupuesto en bytes (PresupuestoShards, configurable como la
+// memoria del ordenamiento y del join), así que ni el tiempo de apertura ni la memoria
+// residente crecen con el tamaño de las tablas.
+//
+// Los registros que no caben en una entrada empaquetada (varios fragmentos, u offset o
+// tamaño de más de 16 bits) se guardan igual en shards: T<tabla>_D<n>.bin tiene, con la
+// misma numeración por ID, la ubicación completa del primer fragmento y el tramo de sus
+// fragmentos siguientes en T<tabla>_F<n>.bin, un arreglo que solo crece.
+// ---------------------------------------------------------------------------
 
-    // Función auxiliar para verificar si un sector es reservado (Sector0.txt o Sector1.txt)
-    bool isReservedSector(int platoIdx, int superficieIdx, int pistaIdx, int sectorIdx) {
-        return (platoIdx == 0 && superficieIdx == 0 && pistaIdx == 0 && (sectorIdx == 0 || sectorIdx == 1));
-    }
+const uint8_t ENTRADA_OCUPADA = 1;
+const uint8_t ENTRADA_DESBORDADA = 2;     // Metadatos en los shards _D/_F (offset/tam: primer fragmento)
+const long ENTRADAS_POR_SHARD = 4096;     // 52 KB por shard
+const size_t MEMORIA_SHARDS_DEFECTO = 4 * 1024 * 1024; // Bytes de shards mapeados a la vez
 
-    // Carga el diccionario de datos desde el disco a la RAM
-    void cargarDiccionario() {
-        string rutaSector1 = rutaBaseDisco + "/P0/S0/Track0/Sector1.txt";
-        Sector sector1(rutaSector1, capacidadSectorBytes); // Usar el sector real
+#pragma pack(push, 1)
+struct EntradaDiccionario {
+    uint64_t lba;     // Índice lineal del sector (ver Disco::indiceSector)
+    uint16_t offset;
+    uint16_t tam;     // Incluye el '\n'
+    uint8_t flags;    // ENTRADA_OCUPADA | ENTRADA_DESBORDADA; 0 = ID libre o eliminado
+};
 
-        string contenido = sector1.leerTodo();
-        stringstream ss(contenido);
-        string linea;
+// Metadatos de un registro desbordado (shard _D, mismo ID que su EntradaDiccionario)
+struct EntradaDesbordada {
+    uint64_t lba;              // Primer fragmento
+    uint32_t offset;
+    uint32_t tam;              // 0 = sin metadatos
+    uint64_t primerFragmento;  // Posición en los shards _F de los fragmentos siguientes
+    uint32_t numFragmentos;
+};
 
-        diccionarioDeDatosEnRAM.clear(); // Limpiar el diccionario actual
+// Fragmento siguiente de un registro desbordado (shards _F). La posición 1 no es un
+// fragmento: su lba guarda la próxima posición libre del arreglo.
+struct FragmentoDesbordado {
+    uint64_t lba;
+    uint32_t offset;
+    uint32_t tam;
+};
+#pragma pack(pop)
 
-        
-        getline(ss, linea); 
-        while (getline(ss, linea)) {
-            if (linea.empty()) continue; 
-            stringstream ss_linea(linea);
-            string segmento;
-            vector<string> segmentos;
+// Bytes de shards residentes que comparten los almacenes de un disco. Cada almacén desaloja
+// solo sus propios shards (los punteros de otro almacén siguen valiendo), así que conserva
+// al menos el que está usando aunque los demás ocupen todo el presupuesto.
+struct PresupuestoShards {
+    size_t bytesMaximos = MEMORIA_SHARDS_DEFECTO;
+    size_t bytesResidentes = 0;
+};
 
-            while (getline(ss_linea, segmento, '#')) {
-                segmentos.push_back(segmento);
-            }
+template <typename Entrada>
+class AlmacenShards {
+private:
+    struct Shard {
+        long long clave;
+        Entrada* entradas;
+        bool mapeado; // false: copia en memoria que se escribe al archivo (Windows o si mmap falla)
+        bool sucio;
+    };
 
-            if (segmentos.size() >= 9) {
-                RecordMetadata rm;
-                // Asumiendo el formato "R#id#plato#superficie#pista#sector#offset#tam#ocupado"
-                rm.idRegistro = stol(segmentos[1]);
-                rm.platoIdx = stoi(segmentos[2]);
-                rm.superficieIdx = stoi(segmentos[3]);
-                rm.pistaIdx = stoi(segmentos[4]);
-                rm.sectorGlobalEnPista = stoi(segmentos[5]);
-                rm.offset = stol(segmentos[6]);
-                rm.tamRegistro = stoi(segmentos[7]);
-                rm.ocupado = (segmentos[8] == "1"); 
+    string directorio;
+    string prefijoArchivo; // "S" (diccionario), "D" o "F" (desbordados)
+    PresupuestoShards* presupuesto;
+    list<Shard> residentes; // El frente es el usado más recientemente
+    unordered_map<long long, typename list<Shard>::iterator> indice;
+    long cargas;
+    long desalojos;
 
-                diccionarioDeDatosEnRAM.push_back(rm);
-            }
-        }
+    static long long claveShard(int idTabla, long numShard) {
+        return ((long long)idTabla << 40) | numShard;
     }
 
-    // Persiste el diccionario de datos de la RAM al disco (Sector1.txt)
-    void persistirDiccionario() {
-        string rutaSector1 = rutaBaseDisco + "/P0/S0/Track0/Sector1.txt";
-        Sector sector1(rutaSector1, capacidadSectorBytes); // Usar el sector real
-
-        stringstream ss;
-        // Escribir la configuración del disco en la primera línea
-        ss << "CONFIG#" << numPlatos << "#" << numSuperficiesPorPlato << "#"
-           << numPistasPorSuperficie << "#" << numSectoresPorPista << "#"
-           << capacidadSectorBytes << "#" << nombreDisco << "\n";
-
-        for (const auto& rm : diccionarioDeDatosEnRAM) {
-            // Solo persiste los registros ocupados
-            if (rm.ocupado) {
-                ss << "R#" << rm.idRegistro << "#" << rm.platoIdx << "#"
-                   << rm.superficieIdx << "#" << rm.pistaIdx << "#"
-                   << rm.sectorGlobalEnPista << "#" << rm.offset << "#"
-                   << rm.tamRegistro << "#" << (rm.ocupado ? "1" : "0") << "\n";
-            }
-        }
-        sector1.escribir(ss.str(), true); // Sobrescribir el contenido del Sector1.txt
+    static size_t bytesShard() {
+        return ENTRADAS_POR_SHARD * sizeof(Entrada);
     }
 
-    // Extrae el esquema de tabla del Sector0.txt
-    void cargarEsquema() {
-        string rutaSector0 = rutaBaseDisco + "/P0/S0/Track0/Sector0.txt";
-        Sector sector0(rutaSector0, capacidadSectorBytes);
+    string rutaShard(int idTabla, long numShard) const {
+        return directorio + "/T" + to_string(idTabla) + "_" + prefijoArchivo + to_string(numShard) + ".bin";
+    }
 
-        string contenido = sector0.leerTodo();
-        if (!contenido.empty()) {
-            size_t pos = contenido.find("R1#");
-            if (pos != string::npos) {
-                tablaEsquema = contenido.substr(pos + 3); // Extraer después de "R1#"
-                // Eliminar el salto de línea final si existe
-                if (!tablaEsquema.empty() && tablaEsquema.back() == '\n') {
-                    tablaEsquema.pop_back();
-                }
-            } else {
-                tablaEsquema = "";
+    // Lleva al archivo los cambios de un shard. Los mapeados se sincronizan con MS_SYNC: al
+    // volver, las entradas están en disco (fsck y la recuperación dependen de eso), también
+    // al desalojarlo, porque después sincronizar() ya no lo ve.
+    void volcar(Shard& shard) {
+        if (!shard.sucio) return;
+        if (shard.mapeado) {
+#ifndef _WIN32
+            if (msync(shard.entradas, bytesShard(), MS_SYNC) != 0) {
+                cerr << "Error: No se pudo sincronizar el shard " << rutaShard(shard.clave >> 40, shard.clave & ((1LL << 40) - 1)) << endl;
+                return; // Queda sucio: se reintenta en el próximo volcado
             }
+#endif
         } else {
-            tablaEsquema = "";
+            ofstream archivo(rutaShard(shard.clave >> 40, shard.clave & ((1LL << 40) - 1)), ios::binary | ios::trunc);
+            archivo.write((const char*)shard.entradas, bytesShard());
+            METRICA_SUMAR(archivosAbiertos, 1);
+            METRICA_SUMAR(bytesEscritos, bytesShard());
         }
+        shard.sucio = false;
     }
 
-    // Transforma un archivo CSV a un stringstream con '#' como delimitador
-    stringstream transformarCSV_a_stringstream(const string& rutaCSV) {
-        ifstream archivoCSV(rutaCSV);
-        stringstream ssSalida;
-        if (!archivoCSV.is_open()) {
-            cerr << "Error: No se pudo abrir el archivo CSV: " << rutaCSV << endl;
-            return ssSalida;
+    void liberar(Shard& shard) {
+        volcar(shard);
+        presupuesto->bytesResidentes -= bytesShard();
+#ifndef _WIN32
+        if (shard.mapeado) {
+            munmap(shard.entradas, bytesShard());
+            return;
         }
+#endif
+        delete[] shard.entradas;
+    }
 
-        string linea;
-        while (getline(archivoCSV, linea)) {
-            // Reemplazar comas con '#'
-            for (char &c : linea) {
-                if (c == ',') {
-                    c = '#';
-                }
-            }
-            ssSalida << linea << "\n";
+    // Devuelve el shard ya residente o lo carga; nullptr si no existe y no hay que crearlo
+    Shard* obtener(int idTabla, long numShard, bool crear) {
+        long long clave = claveShard(idTabla, numShard);
+        auto it = indice.find(clave);
+        if (it != indice.end()) {
+            residentes.splice(residentes.begin(), residentes, it->second); // Pasa a ser el más reciente
+            return &residentes.front();
         }
-        archivoCSV.close();
-        return ssSalida;
-    }
 
-    // Calcula el próximo ID de registro disponible
-    long getNextRecordId() {
-        if (diccionarioDeDatosEnRAM.empty()) {
-            return 1;
+        string ruta = rutaShard(idTabla, numShard);
+        Shard shard = {clave, nullptr, false, false};
+#ifndef _WIN32
+        int fd = open(ruta.c_str(), crear ? (O_RDWR | O_CREAT) : O_RDWR, 0666);
+        if (fd < 0) {
+            if (crear) cerr << "Error: No se pudo crear el shard del diccionario " << ruta << endl;
+            return nullptr;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && (size_t)info.st_size < bytesShard() && ftruncate(fd, bytesShard()) != 0) {
+            close(fd);
+            cerr << "Error: No se pudo dimensionar el shard " << ruta << endl;
+            return nullptr;
+        }
+        void* mapa = mmap(nullptr, bytesShard(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapa != MAP_FAILED) {
+            shard.entradas = (Entrada*)mapa;
+            shard.mapeado = true;
         }
-        long maxId = 0;
-        for (const auto& rm : diccionarioDeDatosEnRAM) {
-            if (rm.idRegistro > maxId) {
-                maxId = rm.idRegistro;
+#endif
+        if (shard.entradas == nullptr) {
+            // Sin mmap: leer el shard completo a memoria
+            ifstream archivo(ruta, ios::binary);
+            if (!archivo.is_open() && !crear) return nullptr;
+            shard.entradas = new Entrada[ENTRADAS_POR_SHARD]();
+            if (archivo.is_open()) {
+                archivo.read((char*)shard.entradas, bytesShard());
+                METRICA_SUMAR(bytesLeidos, archivo.gcount());
             }
+            shard.sucio = !archivo.is_open(); // Los nuevos se crean al volcarlos
         }
-        return maxId + 1;
-    }
+        METRICA_SUMAR(archivosAbiertos, 1);
 
-    //cilindrico 
-    tuple<int, int, int, int, long> encontrarEspacioCilindrico(int tamanoRequerido) {
-        // Intentar continuar desde la última posición escrita para locality
-        int startPlato = lastPlatoWritten;
-        int startPista = lastPistaWritten;
-        int startSuperficie = lastSuperficieWritten;
-        int startSector = lastSectorWritten;
+        presupuesto->bytesResidentes += bytesShard();
+        ajustar();
+        residentes.push_front(shard);
+        indice[clave] = residentes.begin();
+        cargas++;
+        return &residentes.front();
+    }
 
-        // Bucle principal para recorrer los platos
-        for (int p = 0; p < numPlatos; ++p) {
-            // Asegurarse de que la iteración comience desde el plato correcto
-            int current_plato = (startPlato + p) % numPlatos;
+public:
+    AlmacenShards(const string& dir, const string& prefijo, PresupuestoShards* presupuestoCompartido)
+        : directorio(dir), prefijoArchivo(prefijo), presupuesto(presupuestoCompartido), cargas(0), desalojos(0) {
+        MKDIR(directorio.c_str());
+    }
 
-            // Bucle interno para recorrer las pistas dentro de cada plato (cilindro)
-            for (int t = 0; t < numPistasPorSuperficie; ++t) {
-                // Asegurarse de que la iteración comience desde la pista correcta
-                int current_pista = (startPista + t) % numPistasPorSuperficie;
+    ~AlmacenShards() {
+        for (Shard& shard : residentes) liberar(shard);
+    }
 
-                // Bucle para recorrer las superficies del plato actual, manteniendo la misma pista (cilindro)
-                for (int s = 0; s < numSuperficiesPorPlato; ++s) {
-                    // Asegurarse de que la iteración comience desde la superficie correcta
-                    int current_superficie = (startSuperficie + s) % numSuperficiesPorPlato;
-                    int actual_start_sector = (t == 0 && s == 0) ? startSector : 0;
+    AlmacenShards(const AlmacenShards&) = delete;
+    AlmacenShards& operator=(const AlmacenShards&) = delete;
 
+    // Entrada del registro 'id' (nullptr si su shard no existe). El puntero es válido
+    // hasta el próximo acceso, que puede desalojar el shard: copiar lo necesario.
+    const Entrada* leer(int idTabla, long id) {
+        Shard* shard = obtener(idTabla, (id - 1) / ENTRADAS_POR_SHARD, false);
+        return shard ? &shard->entradas[(id - 1) % ENTRADAS_POR_SHARD] : nullptr;
+    }
 
-                    Pista* pistaObj = platos[current_plato]->getSuperficie(current_superficie)->getPista(current_pista);
-                    if (pistaObj == nullptr) continue;
+    // Entrada del registro 'id' para modificarla; crea el shard si no existe
+    Entrada* escribir(int idTabla, long id) {
+        Shard* shard = obtener(idTabla, (id - 1) / ENTRADAS_POR_SHARD, true);
+        if (shard == nullptr) return nullptr;
+        shard->sucio = true;
+        return &shard->entradas[(id - 1) % ENTRADAS_POR_SHARD];
+    }
 
-                    for (int sec = 0; sec < numSectoresPorPista; ++sec) {
-                        int current_sector = (actual_start_sector + sec) % numSectoresPorPista;
+    // Copia un shard completo (para recorridos: quien recorre puede desalojarlo)
+    bool copiarShard(int idTabla, long numShard, vector<Entrada>& destino) {
+        Shard* shard = obtener(idTabla, numShard, false);
+        if (shard == nullptr) return false;
+        destino.assign(shard->entradas, shard->entradas + ENTRADAS_POR_SHARD);
+        return true;
+    }
 
-                        if (isReservedSector(current_plato, current_superficie, current_pista, current_sector)) {
-                            continue; // Ignorar sectores reservados
-                        }
+    // Desaloja los shards menos usados mientras el total residente supere el presupuesto
+    void ajustar() {
+        while (!residentes.empty() && presupuesto->bytesResidentes > presupuesto->bytesMaximos) {
+            Shard& victima = residentes.back();
+            indice.erase(victima.clave);
+            liberar(victima);
+            residentes.pop_back();
+            desalojos++;
+        }
+    }
 
-                        Sector* sectorObj = pistaObj->getSector(current_sector);
-                        if (sectorObj == nullptr) continue;
+    // Lleva al archivo los cambios pendientes de todos los shards residentes
+    void sincronizar() {
+        for (Shard& shard : residentes) volcar(shard);
+    }
 
-                        long tamActual = sectorObj->obtenerTamArchivo();
-                        if (tamActual + tamanoRequerido <= sectorObj->getCapacidadBytes()) {
-                            // Espacio encontrado. Actualizar la última posición escrita.
-                            lastPlatoWritten = current_plato;
-                            lastSuperficieWritten = current_superficie;
-                            lastPistaWritten = current_pista;
-                            lastSectorWritten = current_sector;
-                            return make_tuple(current_plato, current_superficie, current_pista, current_sector, tamActual);
-                        }
-                    }
-                }
+    // Elimina los shards de una tabla (al crear una tabla con un ID reutilizado)
+    void descartarTabla(int idTabla) {
+        for (auto it = residentes.begin(); it != residentes.end();) {
+            if ((it->clave >> 40) == idTabla) {
+                it->sucio = false;
+                liberar(*it);
+                indice.erase(it->clave);
+                it = residentes.erase(it);
+            } else {
+                ++it;
             }
         }
-        return make_tuple(-1, -1, -1, -1, -1); // No hay espacio
+        for (long n = 0; remove(rutaShard(idTabla, n).c_str()) == 0; ++n) {}
     }
 
+    // Indica si el archivo de un shard existe (sin cargarlo)
+    bool existeShard(int idTabla, long numShard) const {
+        struct stat info;
+        return stat(rutaShard(idTabla, numShard).c_str(), &info) == 0;
+    }
 
-public:
-    Disco(int nPlatos, int nSuperficies, int nPistas, int nSectores, int capSector, const string& nombre)
-        : numPlatos(nPlatos), numSuperficiesPorPlato(nSuperficies), numPistasPorSuperficie(nPistas),
-          numSectoresPorPista(nSectores), capacidadSectorBytes(capSector), nombreDisco(nombre),
-          lastPlatoWritten(0), lastSuperficieWritten(0), lastPistaWritten(0), lastSectorWritten(0) {
-        rutaBaseDisco = "./" + nombreDisco + "_disk";
-        MKDIR(rutaBaseDisco.c_str()); // Crear directorio base del disco
+    size_t getResidentes() const { return residentes.size(); }
+    long getCargas() const { return cargas; }
+    long getDesalojos() const { return desalojos; }
+};
 
-        // Crear la estructura física del disco
-        for (int i = 0; i < numPlatos; ++i) {
-            string rutaPlato = rutaBaseDisco + "/P" + to_string(i);
+// Tabla del catálogo: esquema, secuencia de IDs, diccionarios y espacio propio.
+// Cada sector de datos pertenece como máximo a una tabla (ver Disco::propietarioSector).
+// Los metadatos de los registros están en los shards del diccionario (AlmacenShards).
+struct Tabla {
+    int id;
+    string nombre;
+    string esquema;                                // Ej: "id#nombre#edad"
+    long siguienteId = 1;                          // Próximo ID de registro de esta tabla
+    long numVivos = 0;                             // Registros no eliminados
+    mutable long bytesVivos = -1;                  // Caché de Disco::bytesDeTabla (-1 = sin calcular)
+    vector<string> valoresDiccionario;             // Compresión: índice -> valor
+    unordered_map<string, int> indiceValores;      // Compresión: valor -> índice
+};
+
+const int SIN_PROPIETARIO = -1;
+
+// Resumen de una ejecución de Disco::unirTablas
+struct EstadisticasJoin {
+    bool ok = false;
+    string algoritmo;
+    long filas = 0;
+    int particiones = 0;
+    int hilos = 0;
+    bool derramado = false;        // Se escribieron particiones (grace hash join) o corridas (sort-merge) en disco
+    bool entradaOrdenada = false;  // Sort-merge: alguna entrada no estaba agrupada por la clave y se ordenó
+    int reparticiones = 0;         // Grace hash join: particiones que se volvieron a dividir
+    size_t memoriaMaxima = 0;      // Máximo de bytes de filas retenidas a la vez (ver ContadorMemoria)
+    double segundos = 0;
+};
+
+// Bytes de filas que un algoritmo retiene en memoria (tablas hash, lotes, corridas en
+// construcción) y su máximo. Lo actualizan varios hilos.
+struct ContadorMemoria {
+    atomic<long long> actual{0};
+    atomic<long long> maximo{0};
+
+    void sumar(long long bytes) {
+        long long valor = actual.fetch_add(bytes) + bytes;
+        long long anterior = maximo.load();
+        while (valor > anterior && !maximo.compare_exchange_weak(anterior, valor)) {}
+    }
+
+    void restar(long long bytes) { actual.fetch_sub(bytes); }
+};
+
+// Entrega las filas de un join producidas por varios hilos. Cada hilo acumula un lote
+// propio y lo entrega completo bajo el mutex, para no serializar fila por fila.
+class EmisorJoin {
+private:
+    mutex mtx;
+    const function<void(const string&)>& emitir;
+    long filas;
+
+public:
+    explicit EmisorJoin(const function<void(const string&)>& destino) : emitir(destino), filas(0) {}
+
+    void entregar(vector<string>& lote) {
+        if (lote.empty()) return;
+        lock_guard<mutex> bloqueo(mtx);
+        for (const string& fila : lote) emitir(fila);
+        filas += lote.size();
+        lote.clear();
+    }
+
+    // Agrega una fila al lote del hilo y lo entrega cuando está lleno
+    void agregar(vector<string>& lote, string fila) {
+        lote.push_back(move(fila));
+        if (lote.size() >= FILAS_POR_ENTREGA_JOIN) entregar(lote);
+    }
+
+    long getFilas() {
+        lock_guard<mutex> bloqueo(mtx);
+        return filas;
+    }
+};
+
+// Ejecuta tarea(0..numTareas-1) repartiendo las tareas entre 'hilos' hilos
+void ejecutarEnParalelo(int numTareas, int hilos, const function<void(int)>& tarea) {
+    if (hilos <= 1 || numTareas <= 1) {
+        for (int i = 0; i < numTareas; ++i) tarea(i);
+        return;
+    }
+    atomic<int> siguiente(0);
+    vector<thread> trabajadores;
+    for (int h = 0; h < min(hilos, numTareas); ++h) {
+        trabajadores.emplace_back([&]() {
+            for (int i = siguiente++; i < numTareas; i = siguiente++) tarea(i);
+        });
+    }
+    for (thread& t : trabajadores) t.join();
+}
+
+// Productor/consumidores: el hilo actual ejecuta 'producir', que entrega lotes con la
+// función que recibe, y 'hilos' hilos (los mismos para todos los lotes) los procesan con
+// 'procesar'. Entregar un lote espera mientras haya 'maxPendientes' sin tomar, así los
+// lotes en memoria quedan acotados a maxPendientes + hilos + el que se está armando.
+template <typename Lote>
+void procesarLotesEnParalelo(int hilos, size_t maxPendientes, const function<void(const function<void(Lote&&)>&)>& producir,
+                             const function<void(Lote&)>& procesar) {
+    if (hilos <= 1) {
+        producir([&](Lote&& lote) { procesar(lote); });
+        return;
+    }
+    mutex mtx;
+    condition_variable hayLote, hayLugar;
+    deque<Lote> cola;
+    bool terminado = false;
+    vector<thread> trabajadores;
+    for (int h = 0; h < hilos; ++h) {
+        trabajadores.emplace_back([&]() {
+            while (true) {
+                Lote lote;
+                {
+                    unique_lock<mutex> bloqueo(mtx);
+                    hayLote.wait(bloqueo, [&]() { return !cola.empty() || terminado; });
+                    if (cola.empty()) return;
+                    lote = move(cola.front());
+                    cola.pop_front();
+                }
+                hayLugar.notify_one();
+                procesar(lote);
+            }
+        });
+    }
+    producir([&](Lote&& lote) {
+        unique_lock<mutex> bloqueo(mtx);
+        hayLugar.wait(bloqueo, [&]() { return cola.size() < max<size_t>(1, maxPendientes); });
+        cola.push_back(move(lote));
+        hayLote.notify_one();
+    });
+    {
+        lock_guard<mutex> bloqueo(mtx);
+        terminado = true;
+    }
+    hayLote.notify_all();
+    for (thread& t : trabajadores) t.join();
+}
+
+// Hash de una clave para el grace hash join. Cada nivel de particionado usa otra semilla:
+// las claves que cayeron juntas en una partición se reparten de nuevo al subdividirla.
+size_t hashParticion(const string& clave, int nivel) {
+    uint64_t x = hash<string>()(clave) + 0x9e3779b97f4a7c15ULL * (nivel + 1); // splitmix64
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Ordenamiento externo por una columna con memoria acotada: agregar() acumula registros y,
+// al superar memoriaBytes, los vuelca ordenados en una corrida a 'directorio'; después de
+// preparar(), siguiente() los entrega en orden (fusión k-way de las corridas, estable: a
+// igualdad de clave sale antes el registro agregado antes). Si todo cabe en memoria no se
+// escribe nada. Las corridas se borran al destruirlo.
+class OrdenamientoExterno {
+private:
+    typedef pair<ClaveOrden, string> Fila;
+
+    struct Cabeza {
+        ClaveOrden clave;
+        size_t corrida;
+        string registro;
+    };
+    struct Despues {
+        bool operator()(const Cabeza& a, const Cabeza& b) const {
+            if (b.clave < a.clave) return true;
+            if (a.clave < b.clave) return false;
+            return a.corrida > b.corrida;
+        }
+    };
+
+    // Fusión de un grupo de corridas abiertas a la vez
+    struct Fusion {
+        int columna = 0;
+        vector<ifstream> archivos;
+        priority_queue<Cabeza, vector<Cabeza>, Despues> cola;
+
+        void avanzar(size_t i) {
+            string linea;
+            if (getline(archivos[i], linea)) {
+                METRICA_SUMAR(bytesLeidos, linea.size() + 1);
+                cola.push({ClaveOrden(campoEn(linea, columna)), i, linea});
+            }
+        }
+
+        void abrir(const vector<string>& rutas, int col) {
+            columna = col;
+            archivos = vector<ifstream>(rutas.size());
+            cola = priority_queue<Cabeza, vector<Cabeza>, Despues>();
+            for (size_t i = 0; i < rutas.size(); ++i) {
+                archivos[i].open(rutas[i]);
+                METRICA_SUMAR(archivosAbiertos, 1);
+                avanzar(i);
+            }
+        }
+
+        bool siguiente(string& registro) {
+            if (cola.empty()) return false;
+            Cabeza cabeza = cola.top();
+            cola.pop();
+            registro = move(cabeza.registro);
+            avanzar(cabeza.corrida);
+            return true;
+        }
+    };
+
+    string directorio;
+    string prefijo;
+    int columna;
+    size_t memoriaBytes;
+    ContadorMemoria* contador;
+    vector<Fila> filas;
+    size_t memoriaUsada = 0;
+    vector<string> corridas;
+    int numCorridas = 0;
+    size_t siguienteFila = 0;
+    Fusion fusion;
+
+    string nuevaCorrida() {
+        if (numCorridas == 0) MKDIR(directorio.c_str());
+        string ruta = directorio + "/" + prefijo + to_string(numCorridas++) + ".txt";
+        corridas.push_back(ruta);
+        return ruta;
+    }
+
+    void ordenarFilas() {
+        stable_sort(filas.begin(), filas.end(), [](const Fila& a, const Fila& b) { return a.first < b.first; });
+    }
+
+    void liberarFilas() {
+        if (contador != nullptr) contador->restar(memoriaUsada);
+        filas.clear();
+        filas.shrink_to_fit();
+        memoriaUsada = 0;
+    }
+
+    bool volcarCorrida() {
+        ordenarFilas();
+        string ruta = nuevaCorrida();
+        ofstream salida(ruta, ios::trunc);
+        for (const auto& fila : filas) salida << fila.second << "\n";
+        METRICA_SUMAR(archivosAbiertos, 1);
+        METRICA_SUMAR(bytesEscritos, memoriaUsada);
+        liberarFilas();
+        if (!salida) cerr << "Error: No se pudo escribir la corrida temporal " << ruta << endl;
+        return (bool)salida;
+    }
+
+public:
+    OrdenamientoExterno(const string& dir, const string& prefijoCorridas, int col, size_t memoria,
+                        ContadorMemoria* contadorMemoria = nullptr)
+        : directorio(dir), prefijo(prefijoCorridas), columna(col), memoriaBytes(memoria), contador(contadorMemoria) {}
+
+    ~OrdenamientoExterno() {
+        liberarFilas();
+        fusion.archivos.clear();
+        for (const string& ruta : corridas) remove(ruta.c_str());
+        if (numCorridas > 0) RMDIR(directorio.c_str()); // Solo si quedó vacío
+    }
+
+    OrdenamientoExterno(const OrdenamientoExterno&) = delete;
+    OrdenamientoExterno& operator=(const OrdenamientoExterno&) = delete;
+
+    bool agregar(const string& registro) {
+        string campo = campoEn(registro, columna);
+        size_t costo = sizeof(Fila) + registro.size() + campo.size();
+        memoriaUsada += costo;
+        if (contador != nullptr) contador->sumar(costo);
+        filas.emplace_back(ClaveOrden(campo), registro);
+        return memoriaUsada < memoriaBytes || volcarCorrida();
+    }
+
+    // Termina de agregar. Con corridas, vuelca lo que queda en memoria y las fusiona por
+    // grupos hasta que queden a lo sumo MAX_CORRIDAS_FUSION abiertas a la vez.
+    bool preparar() {
+        if (corridas.empty()) {
+            ordenarFilas();
+            return true;
+        }
+        if (!filas.empty() && !volcarCorrida()) return false;
+        while (corridas.size() > MAX_CORRIDAS_FUSION) {
+            vector<string> pendientes = corridas;
+            corridas.clear();
+            for (size_t i = 0; i < pendientes.size(); i += MAX_CORRIDAS_FUSION) {
+                vector<string> grupo(pendientes.begin() + i, pendientes.begin() + min(i + MAX_CORRIDAS_FUSION, pendientes.size()));
+                string ruta = nuevaCorrida();
+                {
+                    ofstream salida(ruta, ios::trunc);
+                    Fusion parcial;
+                    parcial.abrir(grupo, columna);
+                    string registro;
+                    while (parcial.siguiente(registro)) salida << registro << "\n";
+                    if (!salida) {
+                        cerr << "Error: No se pudo escribir la corrida temporal " << ruta << endl;
+                        corridas.insert(corridas.end(), pendientes.begin() + i, pendientes.end());
+                        return false;
+                    }
+                }
+                for (const string& g : grupo) remove(g.c_str());
+            }
+        }
+        fusion.abrir(corridas, columna);
+        return true;
+    }
+
+    // Siguiente registro en orden; false al terminar
+    bool siguiente(string& registro) {
+        if (!corridas.empty()) return fusion.siguiente(registro);
+        if (siguienteFila >= filas.size()) return false;
+        registro = filas[siguienteFila++].second;
+        return true;
+    }
+
+    int getCorridas() const { return numCorridas; }
+};
+
+// Registros completos de un sector, obtenidos al verificar el disco
+struct LineasSector {
+    long tam = 0;                     // Bytes del archivo
+    long finDatos = 0;                // Fin del último registro terminado en '\n'
+    vector<long> inicios;             // Offset de cada registro completo
+    vector<pair<int, long>> duenos;   // (tabla, id) que lo referencia; id 0 = ninguno, -1 = eliminado
+    struct Continuacion {
+        int registro;
+        int largoCabecera;
+        CabeceraContinuacion cabecera;
+    };
+    vector<Continuacion> continuaciones; // Registros que son fragmentos de continuación, en orden
+
+    long tamRegistro(size_t i) const {
+        return (i + 1 < inicios.size() ? inicios[i + 1] : finDatos) - inicios[i];
+    }
+
+    bool esContinuacion(int r) const {
+        auto it = lower_bound(continuaciones.begin(), continuaciones.end(), r,
+                              [](const Continuacion& c, int registro) { return c.registro < registro; });
+        return it != continuaciones.end() && it->registro == r;
+    }
+};
+
+// Resultado de Disco::verificarDisco (fsck)
+struct InformeVerificacion {
+    int hilos = 0;
+    long sectoresLeidos = 0;
+    long long bytesLeidos = 0;
+    double segundosLectura = 0;        // Fase paralela de lectura de sectores
+    double segundosTotal = 0;
+    long lineasMetadatosInvalidas = 0; // Líneas ilegibles en Sector0/Sector1 al cargar
+    long registrosValidos = 0;
+    long entradasInvalidas = 0;        // offset/tam que no coinciden con un registro del sector
+    long entradasDuplicadas = 0;       // Otro ID ya referencia el mismo registro físico
+    long entradasFueraDeSecuencia = 0; // Entradas válidas con ID >= siguienteId
+    long contadoresIncorrectos = 0;    // Tablas cuyo número de vivos no coincide
+    long registrosSinEntrada = 0;      // Registros de los sectores que ninguna entrada referencia
+    long registrosRecuperados = 0;     // De los anteriores, dados de alta con un ID nuevo
+    long registrosReencadenados = 0;   // Repartidos en varios sectores, rearmados con sus cabeceras de continuación
+    long cadenasIncompletas = 0;       // Primeros fragmentos cuya cadena no está completa (no se dan de alta)
+    long colasTruncadas = 0;           // Sectores que terminan en un registro sin '\n'
+    long sectoresSobreCapacidad = 0;
+    long sectoresLiberados = 0;        // Sectores con dueño y sin registros
+    long sectoresReasignados = 0;      // Sectores cuyo dueño no es la tabla de sus registros
+    bool reparado = false;
+
+    bool consistente() const {
+        return lineasMetadatosInvalidas == 0 && entradasInvalidas == 0 && entradasDuplicadas == 0 &&
+               entradasFueraDeSecuencia == 0 && contadoresIncorrectos == 0 && registrosSinEntrada == 0 &&
+               registrosReencadenados == 0 && colasTruncadas == 0 && sectoresLiberados == 0 && sectoresReasignados == 0;
+    }
+
+    void mostrar(ostream& out) const {
+        double porSegundo = segundosLectura > 0 ? sectoresLeidos / segundosLectura : 0;
+        out << "fsck: " << sectoresLeidos << " sectores (" << bytesLeidos << " bytes) leídos con " << hilos
+            << " hilos en " << fixed << setprecision(3) << segundosLectura << " s, " << setprecision(0) << porSegundo
+            << " sectores/s; total " << setprecision(3) << segundosTotal << " s\n";
+        out.unsetf(ios::fixed);
+        out << setprecision(6);
+        out << "  registros válidos: " << registrosValidos << "\n"
+            << "  líneas de metadatos ilegibles: " << lineasMetadatosInvalidas << "\n"
+            << "  entradas inválidas: " << entradasInvalidas << ", duplicadas: " << entradasDuplicadas
+            << ", fuera de secuencia: " << entradasFueraDeSecuencia << "\n"
+            << "  contadores de vivos incorrectos: " << contadoresIncorrectos << "\n"
+            << "  registros sin entrada: " << registrosSinEntrada << " (recuperados: " << registrosRecuperados << ")\n"
+            << "  registros repartidos reencadenados: " << registrosReencadenados
+            << ", cadenas incompletas: " << cadenasIncompletas << "\n"
+            << "  sectores con registro incompleto al final: " << colasTruncadas
+            << ", sobre la capacidad: " << sectoresSobreCapacidad << "\n"
+            << "  sectores con dueño sin registros: " << sectoresLiberados
+            << ", con dueño incorrecto: " << sectoresReasignados << "\n"
+            << "  estado: " << (consistente() ? "consistente" : (reparado ? "reparado" : "INCONSISTENTE")) << "\n";
+    }
+};
+
+// Clase principal para el Disco
+class Disco {
+private:
+    string nombreDisco;
+    int numPlatos;
+    int numSuperficiesPorPlato;
+    int numPistasPorSuperficie;
+    int numSectoresPorPista;
+    int capacidadSectorBytes;
+    vector<Plato*> platos;
+    string rutaBaseDisco; 
+
+    // Catálogo de tablas (persistido en Sector0.txt)
+    vector<Tabla> tablas;
+    int tablaActiva;                 // Posición en 'tablas' de la tabla en uso (-1 si no hay)
+    vector<int> propietarioSector;   // Id de la tabla dueña de cada sector o SIN_PROPIETARIO
+    PresupuestoShards presupuestoShards;                   // Memoria de los shards residentes (los tres almacenes)
+    AlmacenShards<EntradaDiccionario>* shards;             // Diccionario de datos paginado de todas las tablas
+    AlmacenShards<EntradaDesbordada>* shardsDesbordados;   // Registros desbordados, por ID
+    AlmacenShards<FragmentoDesbordado>* shardsFragmentos;  // Fragmentos siguientes de los desbordados
+    bool catalogoModificado;         // Hay que reescribir Sector0.txt
+    long lineasMetadatosInvalidas;   // Líneas de Sector0/Sector1 que no se pudieron interpretar
+
+    // Compresión por diccionario de valores categóricos (ej. "yes", "furnished", "male")
+    string modoCompresion;                        // COMPRESION_NINGUNA o COMPRESION_DICCIONARIO
+    long long nanosCodificacion;                  // Tiempo acumulado codificando registros
+    long long bytesLogicosEscritos;               // Bytes antes de codificar
+    long long bytesFisicosEscritos;               // Bytes realmente escritos en los sectores
+
+    vector<ZonaSector> zonasSectores; // Zone maps, uno por sector (índice lineal)
+
+    bool silencioso; // Si es true, no se imprimen los mensajes informativos por operación
+
+    // Propiedades de la última posición escrita para optimizar la búsqueda secuencial
+    int lastPlatoWritten;
+    int lastSuperficieWritten;
+    int lastPistaWritten;
+    int lastSectorWritten;
+
+    // Función auxiliar para verificar si un sector es reservado (Sector0.txt o Sector1.txt)
+    bool isReservedSector(int platoIdx, int superficieIdx, int pistaIdx, int sectorIdx) {
+        return (platoIdx == 0 && superficieIdx == 0 && pistaIdx == 0 && (sectorIdx == 0 || sectorIdx == 1));
+    }
+
+    // Índice lineal de un sector dentro del disco
+    int indiceSector(int platoIdx, int superficieIdx, int pistaIdx, int sectorIdx) const {
+        return ((platoIdx * numSuperficiesPorPlato + superficieIdx) * numPistasPorSuperficie + pistaIdx) * numSectoresPorPista + sectorIdx;
+    }
+
+    int getTotalSectores() const {
+        return numPlatos * numSuperficiesPorPlato * numPistasPorSuperficie * numSectoresPorPista;
+    }
+
+    // Inversa de indiceSector
+    void ubicacionSector(long idx, int& platoIdx, int& superficieIdx, int& pistaIdx, int& sectorIdx) const {
+        sectorIdx = idx % numSectoresPorPista;
+        idx /= numSectoresPorPista;
+        pistaIdx = idx % numPistasPorSuperficie;
+        idx /= numPistasPorSuperficie;
+        superficieIdx = idx % numSuperficiesPorPlato;
+        platoIdx = idx / numSuperficiesPorPlato;
+    }
+
+    // El fragmento está dentro de la geometría del disco y fuera de los sectores reservados
+    bool ubicacionValida(const Extension& e) const {
+        return e.platoIdx >= 0 && e.platoIdx < numPlatos && e.superficieIdx >= 0 && e.superficieIdx < numSuperficiesPorPlato &&
+               e.pistaIdx >= 0 && e.pistaIdx < numPistasPorSuperficie && e.sectorGlobalEnPista >= 0 &&
+               e.sectorGlobalEnPista < numSectoresPorPista &&
+               !(e.platoIdx == 0 && e.superficieIdx == 0 && e.pistaIdx == 0 && e.sectorGlobalEnPista < 2) &&
+               e.offset >= 0 && e.tam > 0;
+    }
+
+    Sector* sectorPorIndice(int idx) {
+        int p, s, t, sec;
+        ubicacionSector(idx, p, s, t, sec);
+        return platos[p]->getSuperficie(s)->getPista(t)->getSector(sec);
+    }
+
+    Tabla* getTablaActiva() {
+        return tablaActiva >= 0 ? &tablas[tablaActiva] : nullptr;
+    }
+
+    Tabla* buscarTabla(const string& nombre) {
+        for (auto& t : tablas) {
+            if (t.nombre == nombre) return &t;
+        }
+        return nullptr;
+    }
+
+    Tabla* buscarTablaPorId(int id) {
+        for (auto& t : tablas) {
+            if (t.id == id) return &t;
+        }
+        return nullptr;
+    }
+
+    Tabla& crearTabla(const string& nombre, const string& esquema) {
+        Tabla t;
+        t.id = 0;
+        for (const auto& otra : tablas) t.id = max(t.id, otra.id + 1);
+        t.nombre = nombre;
+        t.esquema = esquema;
+        tablas.push_back(t);
+        catalogoModificado = true;
+        return tablas.back();
+    }
+
+    // La tabla activa puede escribir en sus propios sectores y en los libres
+    bool puedeUsarSector(int idxSector) {
+        int propietario = propietarioSector[idxSector];
+        return propietario == SIN_PROPIETARIO || (tablaActiva >= 0 && propietario == tablas[tablaActiva].id);
+    }
+
+    void reclamarSector(int idxSector, int idTabla) {
+        if (propietarioSector[idxSector] != idTabla) {
+            propietarioSector[idxSector] = idTabla;
+            catalogoModificado = true;
+        }
+    }
+
+    // Metadatos del registro 'id' de la tabla; false si no existe o fue eliminado
+    bool obtenerRegistro(const Tabla& tabla, long id, RecordMetadata& rm) {
+        if (id < 1 || id >= tabla.siguienteId) return false;
+        const EntradaDiccionario* entrada = shards->leer(tabla.id, id);
+        if (entrada == nullptr || !(entrada->flags & ENTRADA_OCUPADA)) return false;
+        if (entrada->flags & ENTRADA_DESBORDADA) return leerDesbordado(tabla, id, rm);
+        desempaquetar(id, *entrada, rm);
+        return true;
+    }
+
+    // Metadatos de un registro desbordado desde los shards _D/_F; false si no están
+    bool leerDesbordado(const Tabla& tabla, long id, RecordMetadata& rm) {
+        const EntradaDesbordada* leida = shardsDesbordados->leer(tabla.id, id);
+        if (leida == nullptr || leida->tam == 0) return false;
+        EntradaDesbordada entrada = *leida; // El puntero deja de valer al leer los fragmentos
+        rm.idRegistro = id;
+        ubicacionSector((long)entrada.lba, rm.platoIdx, rm.superficieIdx, rm.pistaIdx, rm.sectorGlobalEnPista);
+        rm.offset = entrada.offset;
+        rm.tamRegistro = entrada.tam;
+        rm.ocupado = true;
+        rm.extensiones.clear();
+        for (uint32_t i = 0; i < entrada.numFragmentos; ++i) {
+            const FragmentoDesbordado* fragmento = shardsFragmentos->leer(tabla.id, (long)(entrada.primerFragmento + i));
+            if (fragmento == nullptr || fragmento->tam == 0) return false;
+            Extension e;
+            ubicacionSector((long)fragmento->lba, e.platoIdx, e.superficieIdx, e.pistaIdx, e.sectorGlobalEnPista);
+            e.offset = fragmento->offset;
+            e.tam = fragmento->tam;
+            rm.extensiones.push_back(e);
+        }
+        return true;
+    }
+
+    void desempaquetar(long id, const EntradaDiccionario& entrada, RecordMetadata& rm) const {
+        rm.idRegistro = id;
+        ubicacionSector((long)entrada.lba, rm.platoIdx, rm.superficieIdx, rm.pistaIdx, rm.sectorGlobalEnPista);
+        rm.offset = entrada.offset;
+        rm.tamRegistro = entrada.tam;
+        rm.ocupado = true;
+        rm.extensiones.clear();
+    }
+
+    // Guarda los metadatos de un registro: empaquetados en su shard si tiene un solo
+    // fragmento y offset/tamaño caben en 16 bits; si no, en los shards de desbordados. La
+    // entrada empaquetada de un registro desbordado conserva igual la ubicación de su
+    // primer fragmento (si cabe) para que fsck pueda reencadenarlo si se pierden los demás.
+    bool guardarRegistro(Tabla& tabla, const RecordMetadata& rm) {
+        bool cabe = rm.offset <= 0xFFFF && rm.tamRegistro <= 0xFFFF;
+        bool empaquetable = rm.extensiones.empty() && cabe;
+        if (!empaquetable && !guardarDesbordado(tabla, rm)) return false;
+        EntradaDiccionario* entrada = shards->escribir(tabla.id, rm.idRegistro);
+        if (entrada == nullptr) return false;
+        entrada->lba = indiceSector(rm.platoIdx, rm.superficieIdx, rm.pistaIdx, rm.sectorGlobalEnPista);
+        entrada->offset = cabe ? (uint16_t)rm.offset : 0;
+        entrada->tam = cabe ? (uint16_t)rm.tamRegistro : 0;
+        entrada->flags = ENTRADA_OCUPADA | (empaquetable ? 0 : ENTRADA_DESBORDADA);
+        return true;
+    }
+
+    // Escribe los metadatos completos de un registro desbordado. Sus fragmentos siguientes
+    // ocupan un tramo nuevo al final del arreglo _F, salvo que vuelva a guardarse un registro
+    // que ya tenía un tramo suficiente (migración repetida, reparación de fsck).
+    bool guardarDesbordado(Tabla& tabla, const RecordMetadata& rm) {
+        const EntradaDesbordada* anterior = shardsDesbordados->leer(tabla.id, rm.idRegistro);
+        uint64_t primero = 0;
+        if (anterior != nullptr && anterior->tam > 0 && anterior->numFragmentos >= rm.extensiones.size()) {
+            primero = anterior->primerFragmento;
+        } else if (!rm.extensiones.empty()) {
+            FragmentoDesbordado* cabecera = shardsFragmentos->escribir(tabla.id, 1);
+            if (cabecera == nullptr) return false;
+            if (cabecera->lba < 2) cabecera->lba = 2; // La posición 1 es esta cabecera
+            primero = cabecera->lba;
+            cabecera->lba += rm.extensiones.size();
+        }
+        for (size_t i = 0; i < rm.extensiones.size(); ++i) {
+            const Extension& e = rm.extensiones[i];
+            FragmentoDesbordado* fragmento = shardsFragmentos->escribir(tabla.id, (long)(primero + i));
+            if (fragmento == nullptr) return false;
+            fragmento->lba = indiceSector(e.platoIdx, e.superficieIdx, e.pistaIdx, e.sectorGlobalEnPista);
+            fragmento->offset = (uint32_t)e.offset;
+            fragmento->tam = (uint32_t)e.tam;
+        }
+        EntradaDesbordada* entrada = shardsDesbordados->escribir(tabla.id, rm.idRegistro);
+        if (entrada == nullptr) return false;
+        entrada->lba = indiceSector(rm.platoIdx, rm.superficieIdx, rm.pistaIdx, rm.sectorGlobalEnPista);
+        entrada->offset = (uint32_t)rm.offset;
+        entrada->tam = (uint32_t)rm.tamRegistro;
+        entrada->primerFragmento = primero;
+        entrada->numFragmentos = (uint32_t)rm.extensiones.size();
+        return true;
+    }
+
+    // Baja lógica: la entrada queda sin flags (los metadatos de desbordado ya no se consultan)
+    void borrarRegistro(Tabla& tabla, long id) {
+        EntradaDiccionario* entrada = shards->escribir(tabla.id, id);
+        if (entrada != nullptr) entrada->flags = 0;
+    }
+
+    static long numShardsDe(const Tabla& tabla) {
+        return (tabla.siguienteId - 1 + ENTRADAS_POR_SHARD - 1) / ENTRADAS_POR_SHARD;
+    }
+
+    // Recorre en orden de ID los registros vivos de un shard de la tabla
+    void recorrerEntradasShard(const Tabla& tabla, long numShard, const function<void(const RecordMetadata&)>& visitar) {
+        vector<EntradaDiccionario> copia;
+        if (!shards->copiarShard(tabla.id, numShard, copia)) return;
+        RecordMetadata rm;
+        for (long i = 0; i < ENTRADAS_POR_SHARD; ++i) {
+            long id = numShard * ENTRADAS_POR_SHARD + i + 1;
+            if (id >= tabla.siguienteId) break;
+            const EntradaDiccionario& entrada = copia[i];
+            if (!(entrada.flags & ENTRADA_OCUPADA)) continue;
+            if (entrada.flags & ENTRADA_DESBORDADA) {
+                if (leerDesbordado(tabla, id, rm)) visitar(rm);
+            } else {
+                desempaquetar(id, entrada, rm);
+                visitar(rm);
+            }
+        }
+    }
+
+    // Recorre los registros vivos de una tabla en orden de ID, un shard a la vez
+    void recorrerEntradas(const Tabla& tabla, const function<void(const RecordMetadata&)>& visitar) {
+        for (long n = 0; n < numShardsDe(tabla); ++n) recorrerEntradasShard(tabla, n, visitar);
+    }
+
+    // Cursor sobre los registros vivos de una tabla agrupados por sector, de a un shard del
+    // diccionario por vez: los metadatos de un shard (a lo sumo ENTRADAS_POR_SHARD registros)
+    // se ordenan por sector en orden de cilindro y se liberan antes de cargar el siguiente,
+    // así la memoria no crece con la tabla. Cada sector se lee una vez por shard que lo
+    // referencia. Solo se leen los sectores para los que 'incluir' devuelve true.
+    class CursorTabla {
+    private:
+        Disco& disco;
+        const Tabla& tabla;
+        function<bool(int)> incluir;
+        long numShard = 0;
+        vector<RecordMetadata> lote;
+        size_t pos = 0;
+        long sectorActual = -1;
+        string contenido;
+        long lecturas = 0;
+
+        long ordenCilindro(const RecordMetadata& rm) const {
+            return ((long)(rm.pistaIdx * disco.numPlatos + rm.platoIdx) * disco.numSuperficiesPorPlato + rm.superficieIdx) *
+                       disco.numSectoresPorPista + rm.sectorGlobalEnPista;
+        }
+
+        bool cargarShard() {
+            lote.clear();
+            pos = 0;
+            while (lote.empty()) {
+                if (numShard >= numShardsDe(tabla)) return false;
+                disco.recorrerEntradasShard(tabla, numShard++, [&](const RecordMetadata& rm) {
+                    if (!incluir || incluir(disco.indiceSector(rm.platoIdx, rm.superficieIdx, rm.pistaIdx, rm.sectorGlobalEnPista))) {
+                        lote.push_back(rm);
+                    }
+                });
+            }
+            sort(lote.begin(), lote.end(), [&](const RecordMetadata& a, const RecordMetadata& b) {
+                long sa = ordenCilindro(a), sb = ordenCilindro(b);
+                return sa != sb ? sa < sb : a.offset < b.offset;
+            });
+            return true;
+        }
+
+    public:
+        CursorTabla(Disco& d, const Tabla& t, function<bool(int)> incluirSector = nullptr)
+            : disco(d), tabla(t), incluir(move(incluirSector)) {}
+
+        // Siguiente registro físico (sin decodificar) y sus metadatos; false al terminar
+        bool siguiente(RecordMetadata& rm, string& fisico) {
+            while (true) {
+                if (pos >= lote.size() && !cargarShard()) return false;
+                const RecordMetadata& actual = lote[pos++];
+                long orden = ordenCilindro(actual);
+                if (orden != sectorActual) {
+                    contenido = disco.platos[actual.platoIdx]->getSuperficie(actual.superficieIdx)->getPista(actual.pistaIdx)
+                                    ->getSector(actual.sectorGlobalEnPista)->leerTodo();
+                    sectorActual = orden;
+                    lecturas++;
+                }
+                if (actual.offset + actual.tamRegistro > (long)contenido.length()) continue;
+                fisico = contenido.substr(actual.offset, actual.tamRegistro);
+                if (!fisico.empty() && fisico.back() == '\n') fisico.pop_back();
+                if (!actual.extensiones.empty()) {
+                    fisico = disco.leerRegistroFisico(actual); // Traer el resto de los fragmentos
+                }
+                rm = actual;
+                return true;
+            }
+        }
+
+        // Siguiente registro decodificado; false al terminar
+        bool siguiente(string& registro) {
+            RecordMetadata rm;
+            string fisico;
+            if (!siguiente(rm, fisico)) return false;
+            registro = disco.decodificarRegistro(tabla, fisico);
+            return true;
+        }
+
+        long getLecturas() const { return lecturas; }
+    };
+
+    // Recorre con un CursorTabla los registros de los sectores incluidos; 'visitar' recibe el
+    // registro físico (sin decodificar). Devuelve el número de lecturas de sectores.
+    long recorrerPorSectores(const Tabla& tabla, const function<bool(int)>& incluir,
+                             const function<void(const RecordMetadata&, const string&)>& visitar) {
+        CursorTabla cursor(*this, tabla, incluir);
+        RecordMetadata rm;
+        string fisico;
+        while (cursor.siguiente(rm, fisico)) visitar(rm, fisico);
+        return cursor.getLecturas();
+    }
+
+    // Incorpora los valores (ya decodificados) de un registro al zone map de su sector
+    void actualizarZona(int idxSector, const string& datosLogicos) {
+        ZonaSector& zona = zonasSectores[idxSector];
+        vector<string> campos = dividirCampos(datosLogicos);
+        if (campos.size() > zona.columnas.size()) {
+            zona.columnas.resize(campos.size());
+        }
+        for (size_t c = 0; c < campos.size(); ++c) {
+            ResumenColumna& col = zona.columnas[c];
+            if (campos[c].empty()) continue; // Los vacíos no cumplen ninguna condición
+            col.bloom |= bitsBloom(claveIgualdad(campos[c]));
+            if (esNumerico(campos[c])) {
+                double v = stod(campos[c]);
+                if (!col.tieneNumeros) {
+                    col.minimo = col.maximo = v;
+                    col.tieneNumeros = true;
+                } else {
+                    col.minimo = min(col.minimo, v);
+                    col.maximo = max(col.maximo, v);
+                }
+            } else {
+                col.tieneTexto = true;
+            }
+        }
+        zona.numRegistros++;
+    }
+
+    // Formato de una zona: "Z2#indice#numRegistros#col0#col1..." donde cada columna es
+    // "N:min:max:bloom" (solo números), "M:min:max:bloom" (números y texto), "T:bloom"
+    // (solo texto) o "E:bloom" (solo vacíos). Las líneas "Z#" de versiones anteriores
+    // (Bloom sin normalizar) se ignoran y los zone maps se reconstruyen.
+    string serializarZona(int idxSector, const ZonaSector& zona) const {
+        stringstream ss;
+        ss << setprecision(17);
+        ss << "Z2#" << idxSector << "#" << zona.numRegistros;
+        for (const auto& col : zona.columnas) {
+            ss << "#";
+            if (col.tieneNumeros) {
+                ss << (col.tieneTexto ? "M:" : "N:") << col.minimo << ":" << col.maximo << ":";
+            } else if (col.tieneTexto) {
+                ss << "T:";
+            } else {
+                ss << "E:";
+            }
+            ss << hex << col.bloom << dec;
+        }
+        return ss.str();
+    }
+
+    void deserializarZona(const vector<string>& segmentos) {
+        int idx = stoi(segmentos[1]);
+        if (idx < 0 || idx >= (int)zonasSectores.size()) return;
+        ZonaSector zona;
+        zona.numRegistros = stoi(segmentos[2]);
+        for (size_t i = 3; i < segmentos.size(); ++i) {
+            vector<string> partes;
+            stringstream ss(segmentos[i]);
+            string parte;
+            while (getline(ss, parte, ':')) partes.push_back(parte);
+            if (partes.empty()) continue;
+
+            ResumenColumna col;
+            col.bloom = stoull(partes.back(), nullptr, 16);
+            if ((partes[0] == "N" || partes[0] == "M") && partes.size() == 4) {
+                col.tieneNumeros = true;
+                col.minimo = stod(partes[1]);
+                col.maximo = stod(partes[2]);
+            }
+            col.tieneTexto = partes[0] == "M" || partes[0] == "T";
+            zona.columnas.push_back(col);
+        }
+        zonasSectores[idx] = zona;
+    }
+
+    // Recalcula todos los zone maps leyendo los registros ocupados (discos sin líneas Z)
+    void reconstruirZonas() {
+        zonasSectores.assign(getTotalSectores(), ZonaSector());
+        for (const auto& tabla : tablas) {
+            recorrerEntradas(tabla, [&](const RecordMetadata& rm) {
+                string registro = decodificarRegistro(tabla, leerRegistroFisico(rm));
+                for (const Extension& e : fragmentosDe(rm)) {
+                    actualizarZona(indiceSector(e.platoIdx, e.superficieIdx, e.pistaIdx, e.sectorGlobalEnPista), registro);
+                }
+            });
+        }
+    }
+
+    // Todos los fragmentos de un registro en orden lógico (el primero es la ubicación principal)
+    static vector<Extension> fragmentosDe(const RecordMetadata& rm) {
+        vector<Extension> fragmentos;
+        fragmentos.push_back({rm.platoIdx, rm.superficieIdx, rm.pistaIdx, rm.sectorGlobalEnPista, rm.offset, rm.tamRegistro});
+        fragmentos.insert(fragmentos.end(), rm.extensiones.begin(), rm.extensiones.end());
+        return fragmentos;
+    }
+
+    // Largo de la cabecera de continuación de un registro de bytesDatos bytes
+    int tamCabeceraContinuacion(long bytesDatos) const {
+        return 5 + cifrasDecimales(getTotalSectores()) + cifrasDecimales(capacidadSectorBytes) + 2 * cifrasDecimales(bytesDatos);
+    }
+
+    string cabeceraContinuacion(const Extension& primero, long posicion, long total) const {
+        auto campo = [](long valor, int ancho) {
+            string texto = to_string(valor);
+            return string(max(0, ancho - (int)texto.size()), '0') + texto;
+        };
+        long lba = indiceSector(primero.platoIdx, primero.superficieIdx, primero.pistaIdx, primero.sectorGlobalEnPista);
+        return MARCA_CONTINUACION + campo(lba, cifrasDecimales(getTotalSectores())) + ":" +
+               campo(primero.offset, cifrasDecimales(capacidadSectorBytes)) + ":" +
+               campo(posicion, cifrasDecimales(total)) + ":" + campo(total, cifrasDecimales(total)) + MARCA_CONTINUACION;
+    }
+
+    // Lee todos los fragmentos de un registro en una pasada y los une (sin los '\n'
+    // que terminan cada fragmento ni las cabeceras de continuación). Devuelve los datos
+    // tal como están en disco.
+    string leerRegistroFisico(const RecordMetadata& rm) {
+        string registro;
+        bool primero = true;
+        for (const Extension& e : fragmentosDe(rm)) {
+            Sector* sector = platos[e.platoIdx]
+                               ->getSuperficie(e.superficieIdx)
+                               ->getPista(e.pistaIdx)
+                               ->getSector(e.sectorGlobalEnPista);
+            if (!sector) return "";
+            string fragmento = sector->leer(e.offset, e.tam);
+            if (!fragmento.empty() && fragmento.back() == '\n') fragmento.pop_back();
+            CabeceraContinuacion cabecera;
+            size_t inicioDatos = primero ? 0 : leerCabeceraContinuacion(fragmento, 0, fragmento.size(), cabecera);
+            registro.append(fragmento, inicioDatos, string::npos);
+            primero = false;
+        }
+        return registro;
+    }
+
+    // Indica si un sector podría contener registros que cumplan "columna operador valor".
+    // Usa el mismo orden que cumpleCondicion (compararValores): los vacíos no cumplen nada
+    // y cualquier texto es mayor que cualquier número.
+    bool zonaPuedeCoincidir(const ZonaSector& zona, int columna, const string& operador, const string& valor) const {
+        if (zona.numRegistros == 0 || valor.empty()) return false;
+        if (columna >= (int)zona.columnas.size()) return true; // Sin información: no se puede descartar
+        const ResumenColumna& col = zona.columnas[columna];
+        ClaveOrden v(valor);
+        uint64_t bits = bitsBloom(claveIgualdad(valor));
+        bool enBloom = (col.bloom & bits) == bits;
+
+        // Números del sector: alguno en [mínimo, máximo] puede cumplir la condición
+        if (col.tieneNumeros) {
+            int cmpMinimo = compararValores(ClaveOrden(col.minimo), v);
+            int cmpMaximo = compararValores(ClaveOrden(col.maximo), v);
+            bool posible = true;
+            if (operador == "=") posible = cmpMinimo <= 0 && cmpMaximo >= 0 && enBloom;
+            else if (operador == "<" || operador == "<=") posible = cumpleOperador(cmpMinimo, operador);
+            else if (operador == ">" || operador == ">=") posible = cumpleOperador(cmpMaximo, operador);
+            if (posible) return true;
+        }
+        // Textos del sector: solo se conoce el filtro de Bloom, no su rango
+        if (col.tieneTexto) {
+            if (operador == "=") return v.clase == 2 && enBloom;
+            if (v.clase == 1) return operador != "<" && operador != "<="; // Un texto nunca es menor que un número
+            return true;
+        }
+        return false;
+    }
+
+    // Evalúa "campo operador valor" sobre un valor concreto de un registro. Un campo (o un
+    // valor buscado) vacío es nulo y no cumple ninguna condición, ni siquiera "!=".
+    static bool cumpleCondicion(const string& campo, const string& operador, const string& valor) {
+        if (campo.empty() || valor.empty()) return false;
+        return cumpleOperador(compararValores(ClaveOrden(campo), ClaveOrden(valor)), operador);
+    }
+
+    // Carga el diccionario de datos: Sector1.txt tiene la configuración, los zone maps, los
+    // diccionarios de valores y, por tabla, "TABLA#id#siguienteId#vivos". Los registros están
+    // en los shards, que se leen a demanda. Las líneas R de discos anteriores (todos los
+    // registros, o solo los desbordados) se migran a los shards aquí.
+    void cargarDiccionario() {
+        string rutaSector1 = rutaBaseDisco + "/P0/S0/Track0/Sector1.txt";
+        Sector sector1(rutaSector1, capacidadSectorBytes); // Usar el sector real
+
+        string contenido = sector1.leerTodo();
+        stringstream ss(contenido);
+        string linea;
+
+        for (auto& t : tablas) { // Limpiar los diccionarios actuales
+            t.numVivos = 0;
+            t.valoresDiccionario.clear();
+            t.indiceValores.clear();
+        }
+        zonasSectores.assign(getTotalSectores(), ZonaSector());
+        bool hayZonas = false;
+        bool zonasAntiguas = false;
+        long migrados = 0;
+        // Discos sin propietarios en el catálogo: los sectores pertenecen a la tabla de sus registros
+        bool hayPropietarios = any_of(propietarioSector.begin(), propietarioSector.end(),
+                                      [](int p) { return p != SIN_PROPIETARIO; });
+        bool vivosConocidos = false; // La línea TABLA trae la cantidad de registros vivos
+
+        // Las líneas previas a cualquier "TABLA#" pertenecen a la tabla 0 (discos de una sola tabla)
+        Tabla* tabla = buscarTablaPorId(0);
+
+        while (getline(ss, linea)) { // La línea CONFIG no coincide con ningún formato y se ignora
+            if (linea.empty()) continue;
+            try {
+                stringstream ss_linea(linea);
+                string segmento;
+                vector<string> segmentos;
+
+                while (getline(ss_linea, segmento, '#')) {
+                    segmentos.push_back(segmento);
+                }
+
+                if (segmentos.size() >= 2 && segmentos[0] == "TABLA") {
+                    // Formato "TABLA#id#siguienteId": las líneas V y R siguientes son de esa tabla
+                    int id = stoi(segmentos[1]);
+                    tabla = buscarTablaPorId(id);
+                    if (tabla == nullptr) {
+                        // Tabla sin entrada en el catálogo: conservar sus registros igualmente
+                        tabla = &crearTabla("tabla" + to_string(id), "");
+                        tabla->id = id;
+                    }
+                    if (segmentos.size() >= 3) {
+                        tabla->siguienteId = stol(segmentos[2]);
+                    }
+                    vivosConocidos = segmentos.size() >= 4;
+                    if (vivosConocidos) {
+                        tabla->numVivos = stol(segmentos[3]);
+                    }
+                } else if (segmentos.size() >= 3 && segmentos[0] == "V") {
+                    // Formato "V#indice#valor" del diccionario de valores
+                    if (tabla == nullptr) tabla = &crearTabla("principal", "");
+                    int idx = stoi(segmentos[1]);
+                    if (idx < 0 || idx > (int)tabla->valoresDiccionario.size()) { // Se escriben en orden
+                        lineasMetadatosInvalidas++;
+                        continue;
+                    }
+                    if (idx >= (int)tabla->valoresDiccionario.size()) {
+                        tabla->valoresDiccionario.resize(idx + 1);
+                    }
+                    tabla->valoresDiccionario[idx] = segmentos[2];
+                    tabla->indiceValores[segmentos[2]] = idx;
+                } else if (segmentos.size() >= 3 && segmentos[0] == "Z2") {
+                    deserializarZona(segmentos);
+                    hayZonas = true;
+                } else if (segmentos[0] == "Z") {
+                    zonasAntiguas = true; // Formato anterior: se reconstruye abajo
+                } else if (segmentos.size() >= 9 && segmentos[0] == "R") {
+                    if (tabla == nullptr) tabla = &crearTabla("principal", "");
+                    RecordMetadata rm;
+                    // Asumiendo el formato "R#id#plato#superficie#pista#sector#offset#tam#ocupado"
+                    rm.idRegistro = stol(segmentos[1]);
+                    rm.platoIdx = stoi(segmentos[2]);
+                    rm.superficieIdx = stoi(segmentos[3]);
+                    rm.pistaIdx = stoi(segmentos[4]);
+                    rm.sectorGlobalEnPista = stoi(segmentos[5]);
+                    rm.offset = stol(segmentos[6]);
+                    rm.tamRegistro = stoi(segmentos[7]);
+                    rm.ocupado = (segmentos[8] == "1"); 
+
+                    // Fragmentos adicionales: "plato:superficie:pista:sector:offset:tam"
+                    for (size_t i = 9; i < segmentos.size(); ++i) {
+                        Extension e;
+                        if (sscanf(segmentos[i].c_str(), "%d:%d:%d:%d:%ld:%d", &e.platoIdx, &e.superficieIdx,
+                                   &e.pistaIdx, &e.sectorGlobalEnPista, &e.offset, &e.tam) == 6) {
+                            rm.extensiones.push_back(e);
+                        }
+                    }
+
+                    if (!rm.ocupado) continue;
+                    vector<Extension> fragmentos = fragmentosDe(rm);
+                    if (rm.idRegistro < 1 || !all_of(fragmentos.begin(), fragmentos.end(),
+                                                     [this](const Extension& e) { return ubicacionValida(e); })) {
+                        lineasMetadatosInvalidas++;
+                        continue;
+                    }
+                    tabla->siguienteId = max(tabla->siguienteId, rm.idRegistro + 1);
+                    // Idempotente: si la migración se interrumpe, se repite al abrir de nuevo
+                    guardarRegistro(*tabla, rm);
+                    migrados++;
+                    if (!vivosConocidos) tabla->numVivos++;
+                    if (!hayPropietarios) {
+                        for (const Extension& e : fragmentos) {
+                            reclamarSector(indiceSector(e.platoIdx, e.superficieIdx, e.pistaIdx, e.sectorGlobalEnPista), tabla->id);
+                        }
+                    }
+                }
+            } catch (const exception&) {
+                // Línea dañada (ej. número ilegible): se omite y la cuenta verificarDisco
+                lineasMetadatosInvalidas++;
+            }
+        }
+
+        bool hayRegistros = any_of(tablas.begin(), tablas.end(), [](const Tabla& t) { return t.numVivos > 0; });
+
+        // Discos creados antes de los zone maps (o con zonas del formato anterior):
+        // reconstruirlos a partir de los registros
+        if (!hayZonas && hayRegistros) {
+            reconstruirZonas();
+        }
+        // Dejar Sector1.txt en el formato actual (sin líneas R, Z2) para no volver a migrar
+        if (migrados > 0 || (zonasAntiguas && hayRegistros)) {
+            persistirDiccionario();
+        }
+    }
+
+    // Persiste el diccionario de datos de la RAM al disco (Sector1.txt)
+    void persistirDiccionario() {
+        METRICA_MEDIR(OP_PERSISTIR_DICCIONARIO);
+        string rutaSector1 = rutaBaseDisco + "/P0/S0/Track0/Sector1.txt";
+        Sector sector1(rutaSector1, capacidadSectorBytes); // Usar el sector real
+
+        stringstream ss;
+        // Escribir la configuración del disco en la primera línea
+        ss << "CONFIG#" << numPlatos << "#" << numSuperficiesPorPlato << "#"
+           << numPistasPorSuperficie << "#" << numSectoresPorPista << "#"
+           << capacidadSectorBytes << "#" << nombreDisco << "#" << modoCompresion << "\n";
+
+        // Zone maps de los sectores con registros
+        for (size_t i = 0; i < zonasSectores.size(); ++i) {
+            if (zonasSectores[i].numRegistros > 0) {
+                ss << serializarZona(i, zonasSectores[i]) << "\n";
+            }
+        }
+
+        // Una sección por tabla: "TABLA#id#siguienteId#vivos" y su diccionario de valores
+        // (los registros están en los shards)
+        for (const auto& tabla : tablas) {
+            ss << "TABLA#" << tabla.id << "#" << tabla.siguienteId << "#" << tabla.numVivos << "\n";
+
+            // Diccionario de valores categóricos
+            for (size_t i = 0; i < tabla.valoresDiccionario.size(); ++i) {
+                ss << "V#" << i << "#" << tabla.valoresDiccionario[i] << "\n";
+            }
+        }
+        sector1.escribir(ss.str(), true); // Sobrescribir el contenido del Sector1.txt
+        shards->sincronizar();
+        shardsDesbordados->sincronizar();
+        shardsFragmentos->sincronizar();
+
+        if (catalogoModificado) {
+            persistirCatalogo();
+        }
+    }
+
+    // Carga el catálogo de tablas del Sector0.txt. Formato:
+    //   T#id#nombre#esquema...        (el esquema usa '#' como separador de columnas)
+    //   E#id#sectorInicial#cantidad   (rango de sectores, por índice lineal, de la tabla)
+    // Un Sector0 antiguo con una sola línea "R1#esquema" se carga como la tabla 0 "principal".
+    void cargarCatalogo() {
+        string rutaSector0 = rutaBaseDisco + "/P0/S0/Track0/Sector0.txt";
+        Sector sector0(rutaSector0, capacidadSectorBytes);
+
+        tablas.clear();
+        tablaActiva = -1;
+        propietarioSector.assign(getTotalSectores(), SIN_PROPIETARIO);
+        lineasMetadatosInvalidas = 0;
+
+        stringstream ss(sector0.leerTodo());
+        string linea;
+        while (getline(ss, linea)) {
+            if (linea.empty()) continue;
+            try {
+                vector<string> segmentos = dividirCampos(linea);
+                if (segmentos[0] == "R1" && tablas.empty()) {
+                    Tabla t;
+                    t.id = 0;
+                    t.nombre = "principal";
+                    t.esquema = linea.substr(3); // Extraer después de "R1#"
+                    tablas.push_back(t);
+                } else if (segmentos[0] == "T" && segmentos.size() >= 3) {
+                    Tabla t;
+                    t.id = stoi(segmentos[1]);
+                    t.nombre = segmentos[2];
+                    size_t inicioEsquema = 2 + segmentos[1].length() + 1 + segmentos[2].length() + 1;
+                    t.esquema = inicioEsquema < linea.length() ? linea.substr(inicioEsquema) : "";
+                    tablas.push_back(t);
+                } else if (segmentos[0] == "E" && segmentos.size() >= 4) {
+                    int id = stoi(segmentos[1]);
+                    int inicio = stoi(segmentos[2]);
+                    int cantidad = stoi(segmentos[3]);
+                    for (int i = inicio; i < inicio + cantidad && i < (int)propietarioSector.size(); ++i) {
+                        if (i >= 0) propietarioSector[i] = id;
+                    }
+                }
+            } catch (const exception&) {
+                // Línea dañada: se omite y la cuenta verificarDisco
+                lineasMetadatosInvalidas++;
+            }
+        }
+        if (!tablas.empty()) {
+            tablaActiva = 0;
+        }
+        catalogoModificado = false;
+    }
+
+    // Reescribe el catálogo (tablas y rangos de sectores de cada una) en Sector0.txt
+    void persistirCatalogo() {
+        string rutaSector0 = rutaBaseDisco + "/P0/S0/Track0/Sector0.txt";
+        Sector sector0(rutaSector0, capacidadSectorBytes);
+
+        stringstream ss;
+        for (const auto& t : tablas) {
+            ss << "T#" << t.id << "#" << t.nombre << "#" << t.esquema << "\n";
+        }
+        // Rangos contiguos de sectores con el mismo propietario
+        int total = propietarioSector.size();
+        for (int i = 0; i < total;) {
+            int j = i;
+            while (j < total && propietarioSector[j] == propietarioSector[i]) j++;
+            if (propietarioSector[i] != SIN_PROPIETARIO) {
+                ss << "E#" << propietarioSector[i] << "#" << i << "#" << (j - i) << "\n";
+            }
+            i = j;
+        }
+        sector0.escribir(ss.str(), true);
+        catalogoModificado = false;
+    }
+
+    // Tabla destino de una carga desde CSV: la crea con el esquema del archivo si no existe
+    // o verifica que el esquema coincida. La deja como tabla activa.
+    Tabla* prepararTablaCarga(const string& rutaCSV, const string& nombreTabla, const string& esquema) {
+        string nombre = nombreTabla.empty() ? nombreTablaDesdeRuta(rutaCSV) : nombreTabla;
+        Tabla* tabla = buscarTabla(nombre);
+        if (tabla == nullptr) {
+            tabla = &crearTabla(nombre, esquema);
+            // Shards que hubieran quedado de una tabla anterior con este ID
+            shards->descartarTabla(tabla->id);
+            shardsDesbordados->descartarTabla(tabla->id);
+            shardsFragmentos->descartarTabla(tabla->id);
+            persistirCatalogo(); // Registrar la tabla y su esquema en Sector0.txt
+            if (!silencioso) cout << "Tabla '" << nombre << "' creada. Esquema: " << tabla->esquema << endl;
+        } else if (tabla->esquema != esquema) {
+            cerr << "Error: El esquema del CSV no coincide con el de la tabla '" << nombre << "'." << endl;
+            return nullptr;
+        } else if (!silencioso) {
+            cout << "Agregando registros a la tabla '" << nombre << "'." << endl;
+        }
+        tablaActiva = tabla - &tablas[0];
+        return tabla;
+    }
+
+    // Nombre de tabla a partir de la ruta de un CSV: "datos/Housing.csv" -> "Housing"
+    static string nombreTablaDesdeRuta(const string& ruta) {
+        size_t barra = ruta.find_last_of("/\\");
+        string nombre = (barra == string::npos) ? ruta : ruta.substr(barra + 1);
+        size_t punto = nombre.find_last_of('.');
+        if (punto != string::npos && punto > 0) nombre = nombre.substr(0, punto);
+        for (char& c : nombre) {
+            if (c == '#' || isspace((unsigned char)c)) c = '_'; // '#' es el separador del catálogo
+        }
+        return nombre.empty() ? "tabla" : nombre;
+    }
+
+    // Transforma un archivo CSV a un stringstream con '#' como delimitador
+    stringstream transformarCSV_a_stringstream(const string& rutaCSV) {
+        ifstream archivoCSV(rutaCSV);
+        stringstream ssSalida;
+        if (!archivoCSV.is_open()) {
+            cerr << "Error: No se pudo abrir el archivo CSV: " << rutaCSV << endl;
+            return ssSalida;
+        }
+
+        string linea;
+        while (getline(archivoCSV, linea)) {
+            convertirLineaCSV(linea);
+            ssSalida << linea << "\n";
+        }
+        archivoCSV.close();
+        return ssSalida;
+    }
+
+    // Recorre los registros vivos (decodificados) de una tabla con memoria acotada (ver
+    // recorrerPorSectores). En una tabla de cargarCSVOrdenado los IDs siguen el orden de
+    // colocación, así que el recorrido sale en orden físico, cilindro por cilindro.
+    void recorrerTabla(const Tabla& tabla, const function<void(const string&)>& visitar) {
+        recorrerPorSectores(tabla, [](int) { return true; }, [&](const RecordMetadata&, const string& registro) {
+            visitar(decodificarRegistro(tabla, registro));
+        });
+    }
+
+    // Bytes en disco de los registros vivos de una tabla (estimación del tamaño de una entrada
+    // del join). Se calcula con una pasada por los shards la primera vez y después se mantiene
+    // al insertar y eliminar.
+    long bytesDeTabla(const Tabla& tabla) {
+        if (tabla.bytesVivos < 0) {
+            long total = 0;
+            recorrerEntradas(tabla, [&](const RecordMetadata& rm) {
+                for (const Extension& e : fragmentosDe(rm)) total += e.tam;
+            });
+            tabla.bytesVivos = total;
+        }
+        return tabla.bytesVivos;
+    }
+
+    // Hash join con memoriaBytes de filas retenidas a lo sumo. Se construye la tabla hash con
+    // la tabla más chica; si cabe en la mitad del presupuesto, el lado de sondeo se lee en
+    // lotes que procesan siempre los mismos 'hilos' hilos (la otra mitad). Si no, ambos lados
+    // se particionan por hash de la clave en <disco>/tmp_join (grace hash join) y cada hilo une
+    // particiones completas con memoriaBytes/hilos: una partición que no entra se vuelve a
+    // dividir con otra semilla (hasta MAX_NIVELES_JOIN veces) y, si aun así no entra (muchas
+    // filas con la misma clave), se une por bloques releyendo su lado de sondeo.
+    void unirPorHash(const Tabla& izq, int colIzq, const Tabla& der, int colDer, EmisorJoin& emisor,
+                     size_t memoriaBytes, int hilos, ContadorMemoria& memoria, EstadisticasJoin& est) {
+        bool construirIzq = bytesDeTabla(izq) <= bytesDeTabla(der);
+        const Tabla& construccion = construirIzq ? izq : der;
+        const Tabla& sondeo = construirIzq ? der : izq;
+        int colConstruccion = construirIzq ? colIzq : colDer;
+        int colSondeo = construirIzq ? colDer : colIzq;
+        typedef unordered_multimap<string, string> TablaHash;
+        // Bytes que ocupa una fila en la tabla hash (clave, fila y nodo)
+        auto costoEnTabla = [](const string& clave, const string& fila) {
+            return sizeof(TablaHash::value_type) + 2 * sizeof(void*) + clave.size() + fila.size();
+        };
+        // La fila de salida siempre es "izquierda#derecha"
+        auto combinar = [construirIzq](const string& filaConstruccion, const string& filaSondeo) {
+            return construirIzq ? filaConstruccion + "#" + filaSondeo : filaSondeo + "#" + filaConstruccion;
+        };
+        // Vacíos = nulos: no se unen con nada
+        auto sondear = [&](const TablaHash& tablaHash, const string& fila, vector<string>& lote) {
+            string clave = claveIgualdad(campoEn(fila, colSondeo));
+            if (clave.empty()) return;
+            auto rango = tablaHash.equal_range(clave);
+            for (auto it = rango.first; it != rango.second; ++it) {
+                emisor.agregar(lote, combinar(it->second, fila));
+            }
+        };
+
+        size_t presupuestoConstruccion = memoriaBytes / 2;
+        size_t estimado = bytesDeTabla(construccion) + construccion.numVivos * costoEnTabla("", "");
+        if (estimado <= presupuestoConstruccion) {
+            // Las filas decodificadas pueden ocupar más que en disco (compresión): si la tabla
+            // hash no entra en el presupuesto se abandona y se pasa al grace hash join
+            TablaHash tablaHash;
+            size_t usados = 0;
+            bool cabe = true;
+            CursorTabla cursor(*this, construccion);
+            string fila;
+            while (cursor.siguiente(fila)) {
+                string clave = claveIgualdad(campoEn(fila, colConstruccion));
+                if (clave.empty()) continue;
+                size_t costo = costoEnTabla(clave, fila);
+                if (usados + costo > presupuestoConstruccion) {
+                    cabe = false;
+                    break;
+                }
+                usados += costo;
+                memoria.sumar(costo);
+                tablaHash.emplace(move(clave), move(fila));
+            }
+            if (cabe) {
+                // Lotes en memoria: los de la cola, uno por hilo y el que se está armando
+                size_t tamLote = max<size_t>(1, min(TAM_LOTE_JOIN, (memoriaBytes - presupuestoConstruccion) / (2 * hilos + 1)));
+                typedef vector<string> LoteSondeo;
+                // La tabla hash solo se lee: los hilos la comparten sin bloqueo
+                procesarLotesEnParalelo<LoteSondeo>(hilos, hilos, [&](const function<void(LoteSondeo&&)>& encolar) {
+                    LoteSondeo lote;
+                    size_t bytesLote = 0;
+                    recorrerTabla(sondeo, [&](const string& fila) {
+                        size_t costo = sizeof(string) + fila.size();
+                        if (!lote.empty() && bytesLote + costo > tamLote) {
+                            encolar(move(lote));
+                            lote = LoteSondeo();
+                            bytesLote = 0;
+                        }
+                        memoria.sumar(costo);
+                        bytesLote += costo;
+                        lote.push_back(fila);
+                    });
+                    if (!lote.empty()) encolar(move(lote));
+                }, [&](LoteSondeo& lote) {
+                    vector<string> salida;
+                    size_t bytesLote = 0;
+                    for (const string& fila : lote) {
+                        sondear(tablaHash, fila, salida);
+                        bytesLote += sizeof(string) + fila.size();
+                    }
+                    emisor.entregar(salida);
+                    memoria.restar(bytesLote);
+                });
+                memoria.restar(usados);
+                est.particiones = 1;
+                return;
+            }
+            memoria.restar(usados);
+        }
+
+        // Grace hash join
+        size_t presupuestoHilo = max<size_t>(1, memoriaBytes / hilos);
+        string dirTemporal = rutaBaseDisco + "/tmp_join";
+        MKDIR(dirTemporal.c_str());
+        atomic<int> hojas(0), reparticiones(0);
+        auto rutaParticion = [&](const string& lado, const string& etiqueta) {
+            return dirTemporal + "/" + lado + etiqueta + ".txt";
+        };
+        // Reparte las filas que entrega 'fuente' en 'numParticiones' archivos según la clave.
+        // Devuelve los bytes escritos en cada partición.
+        auto particionar = [&](const function<void(const function<void(const string&)>&)>& fuente, int columna,
+                               const string& lado, const string& etiqueta, int numParticiones, int nivel) {
+            vector<ofstream> archivos(numParticiones);
+            vector<long> bytes(numParticiones, 0);
+            for (int i = 0; i < numParticiones; ++i) {
+                archivos[i].open(rutaParticion(lado, etiqueta + "_" + to_string(i)), ios::trunc);
+                METRICA_SUMAR(archivosAbiertos, 1);
+            }
+            fuente([&](const string& fila) {
+                string clave = claveIgualdad(campoEn(fila, columna));
+                if (clave.empty()) return;
+                int i = hashParticion(clave, nivel) % numParticiones;
+                archivos[i] << fila << "\n";
+                bytes[i] += fila.size() + 1;
+                METRICA_SUMAR(bytesEscritos, fila.size() + 1);
+            });
+            return bytes;
+        };
+        auto desdeArchivo = [](const string& ruta) {
+            return [ruta](const function<void(const string&)>& visitar) {
+                ifstream archivo(ruta);
+                string fila;
+                while (getline(archivo, fila)) visitar(fila);
+            };
+        };
+        auto particionesPara = [&](long bytes) {
+            return (int)min<long>(MAX_PARTICIONES_JOIN, max<long>(2, 2 * bytes / presupuestoHilo + 1));
+        };
+
+        // Une una partición: en bloques de a lo sumo presupuestoHilo bytes del lado de construcción
+        // (uno solo si entra) o, si es grande y quedan niveles, subdividiéndola
+        function<void(const string&, long, int)> unirParticion = [&](const string& etiqueta, long bytes, int nivel) {
+            string rutaConstruccion = rutaParticion("construccion", etiqueta);
+            string rutaSondeo = rutaParticion("sondeo", etiqueta);
+            if ((size_t)bytes > presupuestoHilo / 2 && nivel <= MAX_NIVELES_JOIN) {
+                int numParticiones = particionesPara(bytes);
+                vector<long> bytesHijas = particionar(desdeArchivo(rutaConstruccion), colConstruccion, "construccion", etiqueta,
+                                                      numParticiones, nivel);
+                particionar(desdeArchivo(rutaSondeo), colSondeo, "sondeo", etiqueta, numParticiones, nivel);
+                remove(rutaConstruccion.c_str());
+                remove(rutaSondeo.c_str());
+                reparticiones++;
+                for (int i = 0; i < numParticiones; ++i) {
+                    // Si todo fue a parar a una sola partición (una misma clave) no tiene sentido seguir dividiendo
+                    int siguienteNivel = bytesHijas[i] == bytes ? MAX_NIVELES_JOIN + 1 : nivel + 1;
+                    unirParticion(etiqueta + "_" + to_string(i), bytesHijas[i], siguienteNivel);
+                }
+                return;
+            }
+
+            ifstream archivoConstruccion(rutaConstruccion);
+            string fila, pendiente;
+            bool quedan = true;
+            while (quedan) {
+                TablaHash tablaHash;
+                size_t usados = 0;
+                quedan = false;
+                auto agregar = [&](string& f) {
+                    string clave = claveIgualdad(campoEn(f, colConstruccion));
+                    size_t costo = costoEnTabla(clave, f);
+                    usados += costo;
+                    memoria.sumar(costo);
+                    tablaHash.emplace(move(clave), move(f));
+                };
+                if (!pendiente.empty()) agregar(pendiente);
+                pendiente.clear();
+                while (getline(archivoConstruccion, fila)) {
+                    if (!tablaHash.empty() &&
+                        usados + costoEnTabla(claveIgualdad(campoEn(fila, colConstruccion)), fila) > presupuestoHilo) {
+                        pendiente = fila; // Abre el próximo bloque
+                        quedan = true;
+                        break;
+                    }
+                    agregar(fila);
+                }
+                if (tablaHash.empty()) break;
+                vector<string> salida;
+                ifstream archivoSondeo(rutaSondeo);
+                while (getline(archivoSondeo, fila)) sondear(tablaHash, fila, salida);
+                emisor.entregar(salida);
+                memoria.restar(usados);
+            }
+            archivoConstruccion.close();
+            remove(rutaConstruccion.c_str());
+            remove(rutaSondeo.c_str());
+            hojas++;
+        };
+
+        // Primer nivel: particiones de a lo sumo ~presupuestoHilo/2 del lado de construcción
+        int numParticiones = max(hilos, particionesPara(estimado));
+        numParticiones = min(numParticiones, MAX_PARTICIONES_JOIN);
+        vector<long> bytesParticion = particionar([&](const function<void(const string&)>& visitar) { recorrerTabla(construccion, visitar); },
+                                                  colConstruccion, "construccion", "", numParticiones, 0);
+        particionar([&](const function<void(const string&)>& visitar) { recorrerTabla(sondeo, visitar); },
+                    colSondeo, "sondeo", "", numParticiones, 0);
+        ejecutarEnParalelo(numParticiones, hilos, [&](int i) { unirParticion("_" + to_string(i), bytesParticion[i], 1); });
+
+        RMDIR(dirTemporal.c_str());
+        est.particiones = hojas;
+        est.reparticiones = reparticiones;
+        est.derramado = true;
+    }
+
+    // Sort-merge join en streaming. Una tabla agrupada por la clave (cargarCSVOrdenado) se lee
+    // directamente en orden físico; si no lo está, se ordena con un OrdenamientoExterno (corridas
+    // en <disco>/tmp_join). Cada entrada retiene a lo sumo memoriaBytes/4. El hilo actual fusiona
+    // ambas entradas y reparte los grupos de claves iguales entre los hilos: el grupo izquierdo
+    // (hasta memoriaBytes/4) se comparte y el derecho se entrega en lotes (otro cuarto). Un grupo
+    // izquierdo más grande se lleva a disco junto con el derecho y se une por bloques.
+    void unirPorMezcla(const Tabla& izq, int colIzq, const Tabla& der, int colDer, EmisorJoin& emisor,
+                       size_t memoriaBytes, int hilos, ContadorMemoria& memoria, EstadisticasJoin& est) {
+        string dirTemporal = rutaBaseDisco + "/tmp_join";
+
+        // Una pasada (sin retener filas) para saber si la tabla ya está ordenada por la clave
+        auto estaOrdenada = [&](const Tabla& tabla, int columna) {
+            CursorTabla cursor(*this, tabla);
+            string fila;
+            bool primera = true;
+            ClaveOrden anterior(0.0);
+            while (cursor.siguiente(fila)) {
+                string campo = campoEn(fila, columna);
+                if (campo.empty()) continue; // Los vacíos no se unen
+                ClaveOrden clave(campo);
+                if (!primera && clave < anterior) return false;
+                anterior = move(clave);
+                primera = false;
+            }
+            return true;
+        };
+
+        // Entrada ordenada por la clave, sin filas de clave vacía
+        struct Entrada {
+            unique_ptr<CursorTabla> cursor;
+            unique_ptr<OrdenamientoExterno> orden;
+            int columna = 0;
+
+            bool siguiente(string& fila) {
+                if (orden) return orden->siguiente(fila);
+                while (cursor->siguiente(fila)) {
+                    if (!campoEn(fila, columna).empty()) return true;
+                }
+                return false;
+            }
+        };
+        auto prepararEntrada = [&](const Tabla& tabla, int columna, const string& prefijo, Entrada& entrada) {
+            entrada.columna = columna;
+            entrada.cursor.reset(new CursorTabla(*this, tabla));
+            if (estaOrdenada(tabla, columna)) return true;
+            est.entradaOrdenada = true;
+            entrada.orden.reset(new OrdenamientoExterno(dirTemporal, prefijo, columna, max<size_t>(1, memoriaBytes / 4), &memoria));
+            string fila;
+            while (entrada.cursor->siguiente(fila)) {
+                if (!campoEn(fila, columna).empty() && !entrada.orden->agregar(fila)) return false;
+            }
+            entrada.cursor.reset();
+            if (!entrada.orden->preparar()) return false;
+            if (entrada.orden->getCorridas() > 0) est.derramado = true;
+            return true;
+        };
+        Entrada entradaIzq, entradaDer;
+        if (!prepararEntrada(izq, colIzq, "izquierda", entradaIzq) || !prepararEntrada(der, colDer, "derecha", entradaDer)) {
+            cerr << "Error: No se pudo ordenar una entrada del join." << endl;
+            return;
+        }
+
+        // Grupo de filas izquierdas con la misma clave, compartido por los lotes que lo usan
+        struct GrupoIzq {
+            ContadorMemoria& memoria;
+            vector<string> filas;
+            size_t bytes = 0;
+            explicit GrupoIzq(ContadorMemoria& m) : memoria(m) {}
+            ~GrupoIzq() { memoria.restar(bytes); }
+        };
+        struct LoteMezcla {
+            shared_ptr<GrupoIzq> grupo;
+            vector<string> derecha;
+            size_t bytes = 0;
+        };
+        size_t tamLote = max<size_t>(1, min(TAM_LOTE_JOIN, memoriaBytes / 4 / (2 * hilos + 1)));
+        size_t limiteGrupo = max<size_t>(1, memoriaBytes / 4);
+        string rutaGrupoIzq = dirTemporal + "/grupo_izquierda.txt";
+        string rutaGrupoDer = dirTemporal + "/grupo_derecha.txt";
+        // Reparte en lotes las filas derechas que une con 'grupo'
+        auto entregarGrupo = [&](const shared_ptr<GrupoIzq>& grupo, const function<bool(string&)>& siguienteDer,
+                                 const function<void(LoteMezcla&&)>& encolar) {
+            LoteMezcla lote;
+            lote.grupo = grupo;
+            string fila;
+            while (siguienteDer(fila)) {
+                size_t costo = sizeof(string) + fila.size();
+                if (!lote.derecha.empty() && lote.bytes + costo > tamLote) {
+                    encolar(move(lote));
+                    lote = LoteMezcla();
+                    lote.grupo = grupo;
+                }
+                memoria.sumar(costo);
+                lote.bytes += costo;
+                lote.derecha.push_back(move(fila));
+            }
+            if (!lote.derecha.empty()) encolar(move(lote));
+        };
+
+        procesarLotesEnParalelo<LoteMezcla>(hilos, hilos, [&](const function<void(LoteMezcla&&)>& encolar) {
+            string filaIzq, filaDer;
+            bool hayIzq = entradaIzq.siguiente(filaIzq);
+            bool hayDer = entradaDer.siguiente(filaDer);
+            ClaveOrden claveIzq(hayIzq ? campoEn(filaIzq, colIzq) : "");
+            ClaveOrden claveDer(hayDer ? campoEn(filaDer, colDer) : "");
+            auto avanzarIzq = [&]() {
+                hayIzq = entradaIzq.siguiente(filaIzq);
+                if (hayIzq) claveIzq = ClaveOrden(campoEn(filaIzq, colIzq));
+            };
+            auto avanzarDer = [&]() {
+                hayDer = entradaDer.siguiente(filaDer);
+                if (hayDer) claveDer = ClaveOrden(campoEn(filaDer, colDer));
+            };
+            while (hayIzq && hayDer) {
+                if (claveIzq < claveDer) {
+                    avanzarIzq();
+                } else if (claveDer < claveIzq) {
+                    avanzarDer();
+                } else {
+                    // Grupo de claves iguales en ambos lados: producto cruzado
+                    ClaveOrden clave = claveIzq;
+                    auto grupo = make_shared<GrupoIzq>(memoria);
+                    ofstream derrameIzq;
+                    while (hayIzq && !(clave < claveIzq)) {
+                        size_t costo = sizeof(string) + filaIzq.size();
+                        if (!derrameIzq.is_open() && !grupo->filas.empty() && grupo->bytes + costo > limiteGrupo) {
+                            // El grupo no entra: pasa a disco y se une por bloques
+                            MKDIR(dirTemporal.c_str());
+                            derrameIzq.open(rutaGrupoIzq, ios::trunc);
+                            for (const string& fila : grupo->filas) derrameIzq << fila << "\n";
+                            grupo = make_shared<GrupoIzq>(memoria);
+                        }
+                        if (derrameIzq.is_open()) {
+                            derrameIzq << filaIzq << "\n";
+                        } else {
+                            memoria.sumar(costo);
+                            grupo->bytes += costo;
+                            grupo->filas.push_back(filaIzq);
+                        }
+                        avanzarIzq();
+                    }
+                    auto derechaDelGrupo = [&](string& fila) {
+                        if (!hayDer || clave < claveDer) return false;
+                        fila = filaDer;
+                        avanzarDer();
+                        return true;
+                    };
+                    if (!derrameIzq.is_open()) {
+                        entregarGrupo(grupo, derechaDelGrupo, encolar);
+                        continue;
+                    }
+
+                    // Grupo izquierdo en disco: el derecho también, y cada bloque izquierdo de a lo
+                    // sumo limiteGrupo bytes se une con una relectura del derecho
+                    derrameIzq.close();
+                    {
+                        ofstream derrameDer(rutaGrupoDer, ios::trunc);
+                        string fila;
+                        while (derechaDelGrupo(fila)) derrameDer << fila << "\n";
+                    }
+                    ifstream archivoIzq(rutaGrupoIzq);
+                    string fila, pendiente;
+                    bool quedan = true;
+                    while (quedan) {
+                        auto bloque = make_shared<GrupoIzq>(memoria);
+                        quedan = false;
+                        auto agregar = [&](const string& f) {
+                            size_t costo = sizeof(string) + f.size();
+                            memoria.sumar(costo);
+                            bloque->bytes += costo;
+                            bloque->filas.push_back(f);
+                        };
+                        if (!pendiente.empty()) agregar(pendiente);
+                        while (getline(archivoIzq, fila)) {
+                            if (!bloque->filas.empty() && bloque->bytes + sizeof(string) + fila.size() > limiteGrupo) {
+                                pendiente = fila;
+                                quedan = true;
+                                break;
+                            }
+                            agregar(fila);
+                        }
+                        if (bloque->filas.empty()) break;
+                        ifstream archivoDer(rutaGrupoDer);
+                        entregarGrupo(bloque, [&](string& f) { return (bool)getline(archivoDer, f); }, encolar);
+                    }
+                    archivoIzq.close();
+                    remove(rutaGrupoIzq.c_str());
+                    remove(rutaGrupoDer.c_str());
+                    est.derramado = true;
+                }
+            }
+        }, [&](LoteMezcla& lote) {
+            vector<string> salida;
+            for (const string& filaDer : lote.derecha) {
+                for (const string& filaIzq : lote.grupo->filas) {
+                    emisor.agregar(salida, filaIzq + "#" + filaDer);
+                }
+            }
+            emisor.entregar(salida);
+            memoria.restar(lote.bytes);
+            lote.grupo.reset();
+        });
+        if (est.derramado) RMDIR(dirTemporal.c_str()); // Si quedan corridas, lo borra su OrdenamientoExterno
+        est.particiones = 1;
+    }
+
+    // Convierte una línea CSV al formato de registro: '#' como delimitador
+    static void convertirLineaCSV(string& linea) {
+        // Quitar el '\r' de los CSV con fin de línea Windows (Housing.csv, titanicG.csv)
+        if (!linea.empty() && linea.back() == '\r') {
+            linea.pop_back();
+        }
+        // Reemplazar comas con '#'
+        for (char &c : linea) {
+            if (c == ',') {
+                c = '#';
+            }
+        }
+    }
+
+    // Construye el diccionario de valores a partir de las columnas categóricas del CSV
+    // (columnas no numéricas con pocos valores distintos).
+    void construirDiccionarioValores(Tabla& tabla, const string& contenidoCSV) {
+        stringstream ss(contenidoCSV);
+        string linea;
+        getline(ss, linea); // Saltar el esquema
+
+        ValoresCategoricos candidatos;
+        while (getline(ss, linea)) {
+            if (!linea.empty()) candidatos.observar(linea);
+        }
+        construirDiccionarioValores(tabla, candidatos);
+    }
+
+    void construirDiccionarioValores(Tabla& tabla, const ValoresCategoricos& candidatos) {
+        for (size_t c = 0; c < candidatos.distintosPorColumna.size(); ++c) {
+            if (candidatos.descartada[c]) continue;
+            for (const string& valor : candidatos.distintosPorColumna[c]) {
+                if ((int)tabla.valoresDiccionario.size() >= MAX_VALORES_DICCIONARIO) return;
+                if (tabla.indiceValores.count(valor)) continue;
+                // Solo vale la pena si el token es más corto que el valor
+                string token = string(1, MARCA_DICCIONARIO) + to_string(tabla.valoresDiccionario.size());
+                if (token.length() >= valor.length()) continue;
+                tabla.indiceValores[valor] = tabla.valoresDiccionario.size();
+                tabla.valoresDiccionario.push_back(valor);
+            }
+        }
+    }
+
+    // Reemplaza los campos presentes en el diccionario de valores por "@indice"
+    string codificarRegistro(const Tabla& tabla, const string& datos) {
+        if (modoCompresion != COMPRESION_DICCIONARIO) return datos;
+        vector<string> campos = dividirCampos(datos);
+        string resultado;
+        resultado.reserve(datos.length());
+        for (size_t c = 0; c < campos.size(); ++c) {
+            if (c > 0) resultado += '#';
+            auto it = tabla.indiceValores.find(campos[c]);
+            if (it != tabla.indiceValores.end()) {
+                resultado += MARCA_DICCIONARIO;
+                resultado += to_string(it->second);
+            } else {
+                if (!campos[c].empty() && campos[c][0] == MARCA_DICCIONARIO) {
+                    resultado += MARCA_DICCIONARIO; // Escapar la marca
+                }
+                resultado += campos[c];
+            }
+        }
+        return resultado;
+    }
+
+    // Operación inversa de codificarRegistro
+    string decodificarRegistro(const Tabla& tabla, const string& datos) {
+        if (modoCompresion != COMPRESION_DICCIONARIO) return datos;
+        vector<string> campos = dividirCampos(datos);
+        string resultado;
+        resultado.reserve(datos.length() * 2);
+        for (size_t c = 0; c < campos.size(); ++c) {
+            if (c > 0) resultado += '#';
+            const string& campo = campos[c];
+            if (campo.length() >= 2 && campo[0] == MARCA_DICCIONARIO && campo[1] == MARCA_DICCIONARIO) {
+                resultado += campo.substr(1);
+            } else if (campo.length() >= 2 && campo[0] == MARCA_DICCIONARIO) {
+                int idx = atoi(campo.c_str() + 1);
+                if (idx >= 0 && idx < (int)tabla.valoresDiccionario.size()) {
+                    resultado += tabla.valoresDiccionario[idx];
+                } else {
+                    resultado += campo; // Índice inválido: devolver tal cual
+                }
+            } else {
+                resultado += campo;
+            }
+        }
+        return resultado;
+    }
+
+    //cilindrico 
+    tuple<int, int, int, int, long> encontrarEspacioCilindrico(int tamanoRequerido) {
+        METRICA_MEDIR(OP_BUSCAR_ESPACIO);
+        METRICA_SUMAR(asignaciones, 1);
+        // Intentar continuar desde la última posición escrita para locality
+        int startPlato = lastPlatoWritten;
+        int startPista = lastPistaWritten;
+        int startSuperficie = lastSuperficieWritten;
+        int startSector = lastSectorWritten;
+
+        // Bucle principal para recorrer los platos
+        for (int p = 0; p < numPlatos; ++p) {
+            // Asegurarse de que la iteración comience desde el plato correcto
+            int current_plato = (startPlato + p) % numPlatos;
+
+            // Bucle interno para recorrer las pistas dentro de cada plato (cilindro)
+            for (int t = 0; t < numPistasPorSuperficie; ++t) {
+                // Asegurarse de que la iteración comience desde la pista correcta
+                int current_pista = (startPista + t) % numPistasPorSuperficie;
+
+                // Bucle para recorrer las superficies del plato actual, manteniendo la misma pista (cilindro)
+                for (int s = 0; s < numSuperficiesPorPlato; ++s) {
+                    // Asegurarse de que la iteración comience desde la superficie correcta
+                    int current_superficie = (startSuperficie + s) % numSuperficiesPorPlato;
+                    int actual_start_sector = (t == 0 && s == 0) ? startSector : 0;
+
+
+                    Pista* pistaObj = platos[current_plato]->getSuperficie(current_superficie)->getPista(current_pista);
+                    if (pistaObj == nullptr) continue;
+
+                    for (int sec = 0; sec < numSectoresPorPista; ++sec) {
+                        int current_sector = (actual_start_sector + sec) % numSectoresPorPista;
+
+                        if (isReservedSector(current_plato, current_superficie, current_pista, current_sector)) {
+                            continue; // Ignorar sectores reservados
+                        }
+                        if (!puedeUsarSector(indiceSector(current_plato, current_superficie, current_pista, current_sector))) {
+                            continue; // Sector de otra tabla
+                        }
+
+                        Sector* sectorObj = pistaObj->getSector(current_sector);
+                        if (sectorObj == nullptr) continue;
+
+                        METRICA_SUMAR(sectoresSondeados, 1);
+                        long tamActual = sectorObj->obtenerTamArchivo();
+                        if (tamActual + tamanoRequerido <= sectorObj->getCapacidadBytes()) {
+                            // Espacio encontrado. Actualizar la última posición escrita.
+                            lastPlatoWritten = current_plato;
+                            lastSuperficieWritten = current_superficie;
+                            lastPistaWritten = current_pista;
+                            lastSectorWritten = current_sector;
+                            return make_tuple(current_plato, current_superficie, current_pista, current_sector, tamActual);
+                        }
+                    }
+                }
+            }
+        }
+        return make_tuple(-1, -1, -1, -1, -1); // No hay espacio
+    }
+
+    // Reparte un registro de bytesDatos bytes (sin '\n') en fragmentos para cuando no cabe en
+    // un solo sector. Primero busca un cilindro (la misma pista en todos los platos y
+    // superficies) con espacio suficiente para todos los fragmentos, de modo que leerlos no
+    // requiera mover el brazo; si ninguno alcanza, usa cilindros consecutivos a partir del
+    // actual. Cada fragmento salvo el primero reserva lugar para su cabecera de
+    // continuación. Devuelve una lista vacía si no hay espacio.
+    vector<Extension> encontrarExtensionesCilindricas(int bytesDatos) {
+        METRICA_MEDIR(OP_BUSCAR_ESPACIO);
+        METRICA_SUMAR(asignaciones, 1);
+        int cabecera = tamCabeceraContinuacion(bytesDatos);
+
+        // Bytes de datos que admite un candidato según sea o no el primer fragmento
+        auto datosDe = [&](const Extension& e, bool esPrimero) {
+            return max(0, e.tam - 1 - (esPrimero ? 0 : cabecera));
+        };
+
+        // Colas libres aprovechables de cada sector del cilindro
+        auto libresDelCilindro = [&](int pista) {
+            vector<Extension> libres;
+            for (int p = 0; p < numPlatos; ++p) {
+                for (int s = 0; s < numSuperficiesPorPlato; ++s) {
+                    Pista* pistaObj = platos[p]->getSuperficie(s)->getPista(pista);
+                    if (pistaObj == nullptr) continue;
+                    for (int sec = 0; sec < numSectoresPorPista; ++sec) {
+                        if (isReservedSector(p, s, pista, sec)) continue;
+                        if (!puedeUsarSector(indiceSector(p, s, pista, sec))) continue;
+                        Sector* sectorObj = pistaObj->getSector(sec);
+                        if (sectorObj == nullptr) continue;
+                        METRICA_SUMAR(sectoresSondeados, 1);
+                        long tamActual = sectorObj->obtenerTamArchivo();
+                        long libre = sectorObj->getCapacidadBytes() - tamActual;
+                        if (libre >= TAM_MIN_FRAGMENTO) {
+                            libres.push_back({p, s, pista, sec, tamActual, (int)libre});
+                        }
+                    }
+                }
+            }
+            return libres;
+        };
+
+        // Recorta los fragmentos candidatos a lo que realmente se necesita
+        auto repartir = [&](const vector<Extension>& candidatos) {
+            vector<Extension> fragmentos;
+            long restante = bytesDatos;
+            for (Extension e : candidatos) {
+                if (restante <= 0) break;
+                bool esPrimero = fragmentos.empty();
+                int datos = (int)min<long>(datosDe(e, esPrimero), restante);
+                if (datos <= 0) continue;
+                e.tam = datos + 1 + (esPrimero ? 0 : cabecera);
+                restante -= datos;
+                fragmentos.push_back(e);
+            }
+            const Extension& ultimo = fragmentos.back();
+            lastPlatoWritten = ultimo.platoIdx;
+            lastSuperficieWritten = ultimo.superficieIdx;
+            lastPistaWritten = ultimo.pistaIdx;
+            lastSectorWritten = ultimo.sectorGlobalEnPista;
+            return fragmentos;
+        };
+
+        // Pasada 1: un solo cilindro
+        vector<vector<Extension>> libresPorCilindro(numPistasPorSuperficie);
+        for (int t = 0; t < numPistasPorSuperficie; ++t) {
+            int pista = (lastPistaWritten + t) % numPistasPorSuperficie;
+            libresPorCilindro[t] = libresDelCilindro(pista);
+            long total = 0;
+            for (const Extension& e : libresPorCilindro[t]) total += datosDe(e, total == 0);
+            if (total >= bytesDatos) {
+                return repartir(libresPorCilindro[t]);
+            }
+        }
+
+        // Pasada 2: cilindros consecutivos (mínimo número de búsquedas)
+        vector<Extension> acumulados;
+        long total = 0;
+        for (int t = 0; t < numPistasPorSuperficie; ++t) {
+            for (const Extension& e : libresPorCilindro[t]) {
+                acumulados.push_back(e);
+                total += datosDe(e, total == 0);
+                if (total >= bytesDatos) {
+                    return repartir(acumulados);
+                }
+            }
+        }
+        return {};
+    }
+
+
+public:
+    Disco(int nPlatos, int nSuperficies, int nPistas, int nSectores, int capSector, const string& nombre,
+          const string& compresion = COMPRESION_NINGUNA)
+        : numPlatos(nPlatos), numSuperficiesPorPlato(nSuperficies), numPistasPorSuperficie(nPistas),
+          numSectoresPorPista(nSectores), capacidadSectorBytes(capSector), nombreDisco(nombre),
+          tablaActiva(-1), catalogoModificado(false), lineasMetadatosInvalidas(0),
+          modoCompresion(compresion), nanosCodificacion(0), bytesLogicosEscritos(0), bytesFisicosEscritos(0),
+          silencioso(false),
+          lastPlatoWritten(0), lastSuperficieWritten(0), lastPistaWritten(0), lastSectorWritten(0) {
+        rutaBaseDisco = "./" + nombreDisco + "_disk";
+        MKDIR(rutaBaseDisco.c_str()); // Crear directorio base del disco
+        shards = new AlmacenShards<EntradaDiccionario>(rutaBaseDisco + "/diccionario", "S", &presupuestoShards);
+        shardsDesbordados = new AlmacenShards<EntradaDesbordada>(rutaBaseDisco + "/diccionario", "D", &presupuestoShards);
+        shardsFragmentos = new AlmacenShards<FragmentoDesbordado>(rutaBaseDisco + "/diccionario", "F", &presupuestoShards);
+
+        // Crear la estructura física del disco
+        for (int i = 0; i < numPlatos; ++i) {
+            string rutaPlato = rutaBaseDisco + "/P" + to_string(i);
             MKDIR(rutaPlato.c_str()); // Crear directorio para el plato
             platos.push_back(new Plato(rutaBaseDisco, i, numSuperficiesPorPlato, numPistasPorSuperficie, numSectoresPorPista, capacidadSectorBytes));
         }
         Sector sector0_init(rutaBaseDisco + "/P0/S0/Track0/Sector0.txt", capacidadSectorBytes);
         Sector sector1_init(rutaBaseDisco + "/P0/S0/Track0/Sector1.txt", capacidadSectorBytes);
 
+        zonasSectores.assign(getTotalSectores(), ZonaSector());
+
         //persistirDiccionario(); 
-        cargarEsquema(); // Carga esquema (inicialmente vacío)
+        cargarCatalogo(); // Carga el catálogo de tablas (inicialmente vacío)
     }
 
     ~Disco() {
         for (Plato* p : platos) {
             delete p;
         }
+        delete shards; // Vuelca los shards modificados
+        delete shardsDesbordados;
+        delete shardsFragmentos;
     }
 
     // Cargar un disco existente desde su ruta base
-    static Disco* cargarDisco(const string& ruta) {
+    static Disco* cargarDisco(const string& ruta, bool silencioso = false) {
         ifstream config_file(ruta + "/P0/S0/Track0/Sector1.txt");
         if (!config_file.is_open()) {
             cerr << "Error: No se pudo cargar la configuración del disco desde " << ruta << endl;
@@ -497,150 +2906,560 @@ public:
             return nullptr;
         }
 
-        int nPlatos = stoi(segmentos_config[1]);
-        int nSuperficies = stoi(segmentos_config[2]);
-        int nPistas = stoi(segmentos_config[3]);
-        int nSectores = stoi(segmentos_config[4]);
-        int capSector = stoi(segmentos_config[5]);
+        int nPlatos = 0, nSuperficies = 0, nPistas = 0, nSectores = 0, capSector = 0;
+        try {
+            nPlatos = stoi(segmentos_config[1]);
+            nSuperficies = stoi(segmentos_config[2]);
+            nPistas = stoi(segmentos_config[3]);
+            nSectores = stoi(segmentos_config[4]);
+            capSector = stoi(segmentos_config[5]);
+        } catch (const exception&) {
+            nPlatos = 0;
+        }
+        if (nPlatos <= 0 || nSuperficies <= 0 || nPistas <= 0 || nSectores < 2 || capSector <= 0) {
+            cerr << "Error: Geometría de disco inválida en la configuración (use recover con la geometría)." << endl;
+            return nullptr;
+        }
         string nombre = segmentos_config[6];
+        // Discos antiguos no tienen el campo de compresión
+        string compresion = segmentos_config.size() >= 8 ? segmentos_config[7] : COMPRESION_NINGUNA;
 
-        Disco* disco = new Disco(nPlatos, nSuperficies, nPistas, nSectores, capSector, nombre);
+        Disco* disco = new Disco(nPlatos, nSuperficies, nPistas, nSectores, capSector, nombre, compresion);
         disco->rutaBaseDisco = ruta; // Asegurar que la ruta base es la correcta
+        disco->cargarCatalogo(); // Cargar tablas y sus sectores
         disco->cargarDiccionario(); // Cargar diccionario de datos
-        disco->cargarEsquema(); // Cargar esquema
-        cout << "Disco '" << nombre << "' cargado exitosamente desde " << ruta << endl;
+        disco->silencioso = silencioso;
+        if (!silencioso) cout << "Disco '" << nombre << "' cargado exitosamente desde " << ruta << endl;
+        return disco;
+    }
+
+    // Recupera un disco cuya configuración se perdió o está dañada: se abre con la geometría
+    // indicada, se carga lo que siga legible del catálogo y de Sector1 y se reconstruye el
+    // diccionario a partir del contenido de los sectores (verificarDisco con reconstrucción).
+    static Disco* recuperarDisco(int nPlatos, int nSuperficies, int nPistas, int nSectores, int capSector,
+                                 const string& nombre, const string& compresion, InformeVerificacion& informe,
+                                 int hilos = 0, bool silencioso = false) {
+        Disco* disco = new Disco(nPlatos, nSuperficies, nPistas, nSectores, capSector, nombre, compresion);
+        disco->silencioso = silencioso;
+        disco->cargarDiccionario();
+        informe = disco->verificarDisco(true, true, hilos);
+        if (!silencioso) cout << "Disco '" << nombre << "' recuperado en " << disco->rutaBaseDisco << endl;
         return disco;
     }
 
     // Métodos públicos para interactuar con el disco
 
-    // Carga un archivo CSV y lo almacena en el disco
-    void cargarCSV(const string& rutaCSV) {
+    // Carga un archivo CSV en la tabla indicada (por defecto, el nombre del archivo sin
+    // extensión). Si la tabla no existe se crea con el esquema del CSV; si existe, el
+    // esquema debe coincidir y los registros se agregan. La tabla queda como activa.
+    bool cargarCSV(const string& rutaCSV, const string& nombreTabla = "") {
+        METRICA_MEDIR(OP_CARGAR_CSV);
         stringstream ssCSV = transformarCSV_a_stringstream(rutaCSV);
         if (ssCSV.str().empty()) {
             cerr << "El archivo CSV está vacío o no se pudo procesar." << endl;
-            return;
+            return false;
         }
 
         string linea;
         getline(ssCSV, linea);
         if (linea.empty()) {
             cerr << "El archivo CSV no tiene esquema." << endl;
-            return;
+            return false;
         }
 
-        // Almacenar el esquema en Sector0.txt
-        string rutaSector0 = rutaBaseDisco + "/P0/S0/Track0/Sector0.txt";
-        Sector sector0(rutaSector0, capacidadSectorBytes);
-        string esquemaConPrefijo = "R1#" + linea + "\n";
-        sector0.escribir(esquemaConPrefijo, true); // Sobreescribir esquema
-        tablaEsquema = linea; // Actualizar esquema en RAM
+        Tabla* tabla = prepararTablaCarga(rutaCSV, nombreTabla, linea);
+        if (tabla == nullptr) return false;
 
-        cout << "Esquema cargado: " << tablaEsquema << endl;
+        if (modoCompresion == COMPRESION_DICCIONARIO) {
+            construirDiccionarioValores(*tabla, ssCSV.str());
+            if (!silencioso) cout << "Diccionario de valores: " << tabla->valoresDiccionario.size() << " entradas." << endl;
+        }
 
-        // Leer y almacenar los registros
+        // Leer y almacenar los registros; el diccionario se persiste una sola vez al final
+        long fallidos = 0;
         while (getline(ssCSV, linea)) {
-            if (!linea.empty()) {
-                insertarRegistro(linea); // Reutilizar la función de inserción
+            if (!linea.empty() && !escribirRegistro(*tabla, linea)) {
+                fallidos++;
+            }
+        }
+        persistirDiccionario();
+        if (fallidos > 0) {
+            cerr << "Error: " << fallidos << " registro(s) del CSV no se pudieron almacenar." << endl;
+            return false;
+        }
+        if (!silencioso) cout << "Datos del CSV cargados y persistidos." << endl;
+        return true;
+    }
+
+    // Borra de los sectores los fragmentos de un registro que no llegó a darse de alta, para
+    // que no queden datos huérfanos: cada sector vuelve al tamaño que tenía antes de escribirlo
+    void deshacerFragmentos(const vector<Extension>& fragmentos) {
+        for (auto it = fragmentos.rbegin(); it != fragmentos.rend(); ++it) {
+            Sector* sectorObj = sectorPorIndice(indiceSector(it->platoIdx, it->superficieIdx, it->pistaIdx, it->sectorGlobalEnPista));
+            if (sectorObj != nullptr && !sectorObj->truncar(it->offset)) {
+                cerr << "Error: No se pudo deshacer el fragmento escrito en " << sectorObj->getRutaArchivo() << endl;
             }
         }
-        cout << "Datos del CSV cargados y persistidos." << endl;
     }
 
-    // Inserta un nuevo registro en el disco
-    void insertarRegistro(const string& datosRegistro) {
-        // Calcular el tamaño del registro (datos + delimitador de nueva línea)
-        int tamanoRequerido = datosRegistro.length() + 1; // +1 para el '\n'
+    // Da de alta en la tabla un registro ya escrito en 'fragmentos': asigna su ID, marca los
+    // sectores como de la tabla y actualiza sus zone maps y el diccionario de datos en RAM.
+    RecordMetadata registrarRegistro(Tabla& tabla, const string& datosLogicos, const vector<Extension>& fragmentos) {
+        for (const Extension& e : fragmentos) {
+            bytesFisicosEscritos += e.tam;
+            if (tabla.bytesVivos >= 0) tabla.bytesVivos += e.tam;
+            int idx = indiceSector(e.platoIdx, e.superficieIdx, e.pistaIdx, e.sectorGlobalEnPista);
+            reclamarSector(idx, tabla.id);
+            actualizarZona(idx, datosLogicos);
+        }
+        bytesLogicosEscritos += datosLogicos.length() + 1;
 
-        // Encontrar espacio en el disco utilizando la lógica cilíndrica
-        auto [platoIdx, superficieIdx, pistaIdx, sectorGlobalEnPista, offset] = encontrarEspacioCilindrico(tamanoRequerido);
+        const Extension& primero = fragmentos.front();
+        RecordMetadata nuevoRM;
+        nuevoRM.idRegistro = tabla.siguienteId++;
+        nuevoRM.platoIdx = primero.platoIdx;
+        nuevoRM.superficieIdx = primero.superficieIdx;
+        nuevoRM.pistaIdx = primero.pistaIdx;
+        nuevoRM.sectorGlobalEnPista = primero.sectorGlobalEnPista;
+        nuevoRM.offset = primero.offset;
+        nuevoRM.tamRegistro = primero.tam;
+        nuevoRM.ocupado = true;
+        nuevoRM.extensiones.assign(fragmentos.begin() + 1, fragmentos.end());
+        if (!guardarRegistro(tabla, nuevoRM)) {
+            cerr << "Error: No se pudo guardar el registro " << nuevoRM.idRegistro << " en el diccionario." << endl;
+        }
+        tabla.numVivos++;
+        return nuevoRM;
+    }
 
-        if (platoIdx == -1) {
-            cout << "No hay espacio suficiente en el disco para el registro: " << datosRegistro << endl;
-            return;
+    // Carga un CSV ordenado por 'columna' y lo coloca de forma contigua, cilindro por
+    // cilindro, en los sectores vacíos del disco: las consultas por rango sobre esa columna
+    // leen sectores consecutivos y los zone maps quedan ajustados. Ordenamiento externo: se
+    // mantienen a lo sumo 'memoriaBytes' de registros en RAM; el resto se vuelca en corridas
+    // ordenadas a <disco>/tmp_orden que luego se fusionan. Devuelve false si no se completó.
+    bool cargarCSVOrdenado(const string& rutaCSV, const string& columna, const string& nombreTabla = "",
+                           size_t memoriaBytes = MEMORIA_ORDENAMIENTO_DEFECTO) {
+        METRICA_MEDIR(OP_CARGAR_ORDENADO);
+        ifstream archivoCSV(rutaCSV);
+        if (!archivoCSV.is_open()) {
+            cerr << "Error: No se pudo abrir el archivo CSV: " << rutaCSV << endl;
+            return false;
+        }
+        string esquema;
+        getline(archivoCSV, esquema);
+        convertirLineaCSV(esquema);
+        if (esquema.empty()) {
+            cerr << "El archivo CSV no tiene esquema." << endl;
+            return false;
+        }
+        vector<string> columnas = dividirCampos(esquema);
+        auto itColumna = find(columnas.begin(), columnas.end(), columna);
+        if (itColumna == columnas.end()) {
+            cerr << "Error: La columna '" << columna << "' no existe en el esquema del CSV." << endl;
+            return false;
         }
+        int idxColumna = itColumna - columnas.begin();
 
-        // Obtener el sector donde se escribirá el registro
-        Sector* sectorAEscribir = platos[platoIdx]
-                                   ->getSuperficie(superficieIdx)
-                                   ->getPista(pistaIdx)
-                                   ->getSector(sectorGlobalEnPista);
+        Tabla* tabla = prepararTablaCarga(rutaCSV, nombreTabla, esquema);
+        if (tabla == nullptr) return false;
 
-        if (sectorAEscribir == nullptr) {
-            cerr << "Error: Sector no encontrado en la ubicación calculada." << endl;
-            return;
+        // Fase 1: corridas ordenadas. Si todo cabe en memoria no se toca el área temporal.
+        OrdenamientoExterno orden(rutaBaseDisco + "/tmp_orden", "corrida", idxColumna, memoriaBytes);
+        long totalRegistros = 0;
+        ValoresCategoricos candidatos;
+
+        string linea;
+        while (getline(archivoCSV, linea)) {
+            convertirLineaCSV(linea);
+            if (linea.empty()) continue;
+            if (modoCompresion == COMPRESION_DICCIONARIO) candidatos.observar(linea);
+            totalRegistros++;
+            if (!orden.agregar(linea)) return false;
         }
+        archivoCSV.close();
+        if (!orden.preparar()) return false;
 
-        // Escribir el registro en el sector
-        string registroConSalto = datosRegistro + "\n";
-        if (!sectorAEscribir->escribir(registroConSalto)) {
-            cerr << "Error al escribir el registro en el sector: " << sectorAEscribir->getRutaArchivo() << endl;
-            return;
+        if (modoCompresion == COMPRESION_DICCIONARIO) {
+            construirDiccionarioValores(*tabla, candidatos);
         }
 
-        // Actualizar el diccionario de datos en RAM
-        RecordMetadata nuevoRM;
-        nuevoRM.idRegistro = getNextRecordId();
-        nuevoRM.platoIdx = platoIdx;
-        nuevoRM.superficieIdx = superficieIdx;
-        nuevoRM.pistaIdx = pistaIdx;
-        nuevoRM.sectorGlobalEnPista = sectorGlobalEnPista;
-        nuevoRM.offset = offset;
-        nuevoRM.tamRegistro = tamanoRequerido;
-        nuevoRM.ocupado = true;
-        diccionarioDeDatosEnRAM.push_back(nuevoRM);
+        // Fase 2: sectores vacíos disponibles, cilindro por cilindro (la misma pista en todos
+        // los platos y superficies), para que recorrer el resultado en orden sea secuencial
+        vector<Extension> destinos;
+        for (int t = 0; t < numPistasPorSuperficie; ++t) {
+            for (int p = 0; p < numPlatos; ++p) {
+                for (int s = 0; s < numSuperficiesPorPlato; ++s) {
+                    Pista* pistaObj = platos[p]->getSuperficie(s)->getPista(t);
+                    if (pistaObj == nullptr) continue;
+                    for (int sec = 0; sec < numSectoresPorPista; ++sec) {
+                        if (isReservedSector(p, s, t, sec)) continue;
+                        if (!puedeUsarSector(indiceSector(p, s, t, sec))) continue;
+                        Sector* sectorObj = pistaObj->getSector(sec);
+                        if (sectorObj == nullptr || sectorObj->obtenerTamArchivo() > 0) continue;
+                        destinos.push_back({p, s, t, sec, 0, 0});
+                    }
+                }
+            }
+        }
+
+        // Fase 3: colocar en orden. Cada sector se llena en memoria y se escribe de una vez.
+        // Un registro se da de alta solo cuando el sector con su último fragmento ya está
+        // escrito; si una escritura falla, los pendientes se borran de los sectores anteriores.
+        size_t actual = 0;
+        string bufferSector;
+        long colocados = 0;
+        bool sinEspacio = false, errorEscritura = false;
+        vector<pair<string, vector<Extension>>> pendientes;
+
+        auto escribirSectorActual = [&]() {
+            if (bufferSector.empty()) return;
+            const Extension& d = destinos[actual];
+            Sector* sectorObj = platos[d.platoIdx]->getSuperficie(d.superficieIdx)->getPista(d.pistaIdx)->getSector(d.sectorGlobalEnPista);
+            if (sectorObj->escribir(bufferSector)) {
+                for (const auto& pendiente : pendientes) {
+                    registrarRegistro(*tabla, pendiente.first, pendiente.second);
+                    colocados++;
+                }
+            } else {
+                errorEscritura = true;
+                for (auto it = pendientes.rbegin(); it != pendientes.rend(); ++it) deshacerFragmentos(it->second);
+            }
+            pendientes.clear();
+            bufferSector.clear();
+        };
+        auto colocar = [&](const string& datosLogicos) {
+            if (sinEspacio || errorEscritura) return;
+            auto inicioCodificacion = chrono::steady_clock::now();
+            string datosFisicos = codificarRegistro(*tabla, datosLogicos);
+            nanosCodificacion += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - inicioCodificacion).count();
+
+            long libreActual = capacidadSectorBytes - (long)bufferSector.size();
+            vector<Extension> fragmentos;
+            if ((int)datosFisicos.length() + 1 <= capacidadSectorBytes) {
+                if ((long)datosFisicos.length() + 1 > libreActual) {
+                    escribirSectorActual();
+                    actual++;
+                    if (errorEscritura) return;
+                }
+                if (actual >= destinos.size()) {
+                    sinEspacio = true;
+                    return;
+                }
+                Extension e = destinos[actual];
+                e.offset = bufferSector.size();
+                e.tam = datosFisicos.length() + 1;
+                bufferSector += datosFisicos + "\n";
+                fragmentos.push_back(e);
+            } else {
+                // Más grande que un sector: fragmentos en los sectores siguientes, cada uno
+                // (salvo el primero) con su cabecera de continuación
+                int cabecera = tamCabeceraContinuacion(datosFisicos.length());
+                long restantes = (long)destinos.size() - (long)actual - 1;
+                long porContinuacion = max(0, capacidadSectorBytes - 1 - cabecera);
+                long disponible = libreActual >= TAM_MIN_FRAGMENTO
+                                      ? libreActual - 1 + restantes * porContinuacion
+                                      : (restantes > 0 ? capacidadSectorBytes - 1 + (restantes - 1) * porContinuacion : 0);
+                if (actual >= destinos.size() || disponible < (long)datosFisicos.length()) {
+                    sinEspacio = true;
+                    return;
+                }
+                size_t pos = 0;
+                while (pos < datosFisicos.length()) {
+                    libreActual = capacidadSectorBytes - (long)bufferSector.size();
+                    int reservado = fragmentos.empty() ? 0 : cabecera;
+                    if (libreActual < max(TAM_MIN_FRAGMENTO, reservado + 2)) {
+                        escribirSectorActual();
+                        actual++;
+                        if (errorEscritura) {
+                            deshacerFragmentos(fragmentos);
+                            return;
+                        }
+                        continue;
+                    }
+                    int datos = (int)min<long>(libreActual - 1 - reservado, datosFisicos.length() - pos);
+                    Extension e = destinos[actual];
+                    e.offset = bufferSector.size();
+                    e.tam = datos + 1 + reservado;
+                    if (reservado > 0) bufferSector += cabeceraContinuacion(fragmentos[0], pos, datosFisicos.length());
+                    bufferSector += datosFisicos.substr(pos, datos) + "\n";
+                    pos += datos;
+                    fragmentos.push_back(e);
+                }
+            }
+            pendientes.push_back({datosLogicos, fragmentos});
+        };
+
+        while (orden.siguiente(linea)) colocar(linea);
+        if (actual < destinos.size() && !errorEscritura) {
+            escribirSectorActual();
+        }
+
+        if (colocados > 0) {
+            const Extension& ultimo = destinos[min(actual, destinos.size() - 1)];
+            lastPlatoWritten = ultimo.platoIdx;
+            lastSuperficieWritten = ultimo.superficieIdx;
+            lastPistaWritten = ultimo.pistaIdx;
+            lastSectorWritten = ultimo.sectorGlobalEnPista;
+        }
+        persistirDiccionario(); // Una sola vez para toda la carga
+
+        if (sinEspacio) {
+            cerr << "No hay espacio suficiente en el disco: se cargaron " << colocados << " de "
+                 << totalRegistros << " registros." << endl;
+        }
+        if (errorEscritura) {
+            cerr << "Error al escribir un sector durante la carga ordenada." << endl;
+        }
+        if (!silencioso && colocados > 0) {
+            size_t usados = min(actual + 1, destinos.size());
+            cout << "Carga ordenada por '" << columna << "': " << colocados << " registros en " << usados
+                 << " sectores (pistas " << destinos[0].pistaIdx << "-" << destinos[usados - 1].pistaIdx << "), "
+                 << max(orden.getCorridas(), 1) << " corrida(s)." << endl;
+        }
+        return !sinEspacio && !errorEscritura;
+    }
+
+    // Une dos tablas por igualdad de columnas (equi-join) y entrega cada fila
+    // "registroIzq#registroDer" a 'emitir' a medida que se produce; 'emitir' nunca se llama
+    // desde dos hilos a la vez, pero el orden de las filas no está definido. Algoritmos:
+    //   "hash"  en memoria, o grace hash join si la tabla menor no entra en memoriaBytes/2
+    //   "merge" sort-merge en streaming; las tablas que no están agrupadas por la clave
+    //           (cargarCSVOrdenado) se ordenan con corridas externas
+    // memoriaBytes acota las filas retenidas a la vez. Los valores vacíos no se unen.
+    // hilos = 0 usa los núcleos disponibles.
+    EstadisticasJoin unirTablas(const string& nombreIzq, const string& columnaIzq,
+                                const string& nombreDer, const string& columnaDer,
+                                const string& algoritmo, const function<void(const string&)>& emitir,
+                                size_t memoriaBytes = MEMORIA_ORDENAMIENTO_DEFECTO, int hilos = 0) {
+        METRICA_MEDIR(OP_UNIR);
+        EstadisticasJoin est;
+        est.algoritmo = algoritmo;
+        if (algoritmo != "hash" && algoritmo != "merge") {
+            cerr << "Error: Algoritmo de join desconocido '" << algoritmo << "' (use hash o merge)." << endl;
+            return est;
+        }
+        Tabla* izq = buscarTabla(nombreIzq);
+        Tabla* der = buscarTabla(nombreDer);
+        if (izq == nullptr || der == nullptr) {
+            cerr << "Error: La tabla '" << (izq == nullptr ? nombreIzq : nombreDer) << "' no existe." << endl;
+            return est;
+        }
+        auto indiceColumna = [](const Tabla& tabla, const string& columna) {
+            vector<string> columnas = dividirCampos(tabla.esquema);
+            auto it = find(columnas.begin(), columnas.end(), columna);
+            return it == columnas.end() ? -1 : (int)(it - columnas.begin());
+        };
+        int colIzq = indiceColumna(*izq, columnaIzq);
+        int colDer = indiceColumna(*der, columnaDer);
+        if (colIzq < 0 || colDer < 0) {
+            cerr << "Error: La columna '" << (colIzq < 0 ? columnaIzq : columnaDer) << "' no existe en la tabla '"
+                 << (colIzq < 0 ? nombreIzq : nombreDer) << "'." << endl;
+            return est;
+        }
+        if (hilos <= 0) hilos = max(1u, thread::hardware_concurrency());
+        est.hilos = hilos;
+
+        auto inicio = chrono::steady_clock::now();
+        EmisorJoin emisor(emitir);
+        ContadorMemoria memoria;
+        if (algoritmo == "hash") {
+            unirPorHash(*izq, colIzq, *der, colDer, emisor, memoriaBytes, hilos, memoria, est);
+        } else {
+            unirPorMezcla(*izq, colIzq, *der, colDer, emisor, memoriaBytes, hilos, memoria, est);
+        }
+        est.filas = emisor.getFilas();
+        est.memoriaMaxima = memoria.maximo;
+        est.segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+        est.ok = true;
+        return est;
+    }
+
+    // Inserta un nuevo registro en el disco. Devuelve false si no se pudo almacenar.
+    bool insertarRegistro(const string& datosRegistro) {
+        METRICA_MEDIR(OP_INSERTAR);
+        Tabla* tabla = getTablaActiva();
+        if (tabla == nullptr) {
+            cerr << "Error: No hay tabla activa. Cargue un CSV o seleccione una tabla." << endl;
+            return false;
+        }
+        if (!escribirRegistro(*tabla, datosRegistro)) return false;
+
+        // Persistir el diccionario actualizado al disco
+        persistirDiccionario();
+        return true;
+    }
+
+    // Escribe un registro en los sectores y lo da de alta en el diccionario en RAM, sin
+    // persistirlo (insertarRegistro persiste cada registro; cargarCSV, una vez por carga)
+    bool escribirRegistro(Tabla& tabla, const string& datosRegistro) {
+        // Codificar con el diccionario de valores (si la compresión está activa)
+        auto inicioCodificacion = chrono::steady_clock::now();
+        string datosFisicos = codificarRegistro(tabla, datosRegistro);
+        nanosCodificacion += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - inicioCodificacion).count();
+
+        // Calcular el tamaño del registro (datos + delimitador de nueva línea)
+        int tamanoRequerido = datosFisicos.length() + 1; // +1 para el '\n'
+
+        // Encontrar espacio en el disco utilizando la lógica cilíndrica
+        vector<Extension> fragmentos;
+        auto [platoIdx, superficieIdx, pistaIdx, sectorGlobalEnPista, offset] = encontrarEspacioCilindrico(tamanoRequerido);
+        if (platoIdx != -1) {
+            fragmentos.push_back({platoIdx, superficieIdx, pistaIdx, sectorGlobalEnPista, offset, tamanoRequerido});
+        } else {
+            // No cabe en ningún sector: repartirlo en varios fragmentos encadenados
+            fragmentos = encontrarExtensionesCilindricas(datosFisicos.length());
+        }
+
+        if (fragmentos.empty()) {
+            cout << "No hay espacio suficiente en el disco para el registro: " << datosRegistro << endl;
+            return false;
+        }
+
+        // Escribir cada fragmento (terminado en '\n') en su sector. Si uno falla se borran
+        // los ya escritos: el registro no se da de alta y no deben quedar fragmentos huérfanos.
+        size_t posDatos = 0;
+        for (size_t i = 0; i < fragmentos.size(); ++i) {
+            const Extension& e = fragmentos[i];
+            Sector* sectorAEscribir = platos[e.platoIdx]
+                                       ->getSuperficie(e.superficieIdx)
+                                       ->getPista(e.pistaIdx)
+                                       ->getSector(e.sectorGlobalEnPista);
+            if (sectorAEscribir == nullptr) {
+                cerr << "Error: Sector no encontrado en la ubicación calculada." << endl;
+                deshacerFragmentos(vector<Extension>(fragmentos.begin(), fragmentos.begin() + i));
+                return false;
+            }
+            string cabecera = i == 0 ? "" : cabeceraContinuacion(fragmentos[0], posDatos, datosFisicos.length());
+            size_t datos = e.tam - 1 - cabecera.size();
+            string fragmentoConSalto = cabecera + datosFisicos.substr(posDatos, datos) + "\n";
+            if (!sectorAEscribir->escribir(fragmentoConSalto)) {
+                cerr << "Error al escribir el registro en el sector: " << sectorAEscribir->getRutaArchivo() << endl;
+                deshacerFragmentos(vector<Extension>(fragmentos.begin(), fragmentos.begin() + i + 1));
+                return false;
+            }
+            posDatos += datos;
+        }
 
-        cout << "Registro ID " << nuevoRM.idRegistro << " insertado en P" << platoIdx << "/S" << superficieIdx
-             << "/T" << pistaIdx << "/Sec" << sectorGlobalEnPista << " @offset " << offset << endl;
+        RecordMetadata nuevoRM = registrarRegistro(tabla, datosRegistro, fragmentos);
+        const Extension& primero = fragmentos.front();
 
-        // Persistir el diccionario actualizado al disco
-        persistirDiccionario();
+        if (!silencioso) {
+            // '\n' en lugar de endl: no forzar un flush por cada registro en cargas masivas
+            cout << "Registro ID " << nuevoRM.idRegistro << " insertado en P" << primero.platoIdx << "/S" << primero.superficieIdx
+                 << "/T" << primero.pistaIdx << "/Sec" << primero.sectorGlobalEnPista << " @offset " << primero.offset;
+            if (fragmentos.size() > 1) {
+                cout << " (" << fragmentos.size() << " fragmentos)";
+            }
+            cout << "\n";
+        }
+        return true;
     }
 
     // Recupera un registro por su ID
     string recuperarRegistro(long id) {
-        for (const auto& rm : diccionarioDeDatosEnRAM) {
-            if (rm.idRegistro == id && rm.ocupado) {
-                Sector* sector = platos[rm.platoIdx]
-                                   ->getSuperficie(rm.superficieIdx)
-                                   ->getPista(rm.pistaIdx)
-                                   ->getSector(rm.sectorGlobalEnPista);
-                if (sector) {
-                    string registro = sector->leer(rm.offset, rm.tamRegistro);
-                    // Eliminar el salto de línea al final si existe
-                    if (!registro.empty() && registro.back() == '\n') {
-                        registro.pop_back();
-                    }
-                    return registro;
-                }
-            }
+        METRICA_MEDIR(OP_RECUPERAR);
+        Tabla* tabla = getTablaActiva();
+        if (tabla == nullptr) return "";
+        RecordMetadata rm;
+        if (obtenerRegistro(*tabla, id, rm)) {
+            return decodificarRegistro(*tabla, leerRegistroFisico(rm));
         }
         return ""; // Registro no encontrado o eliminado
     }
 
-    // Elimina un registro por su ID (marcando como no ocupado)
-    void eliminarRegistro(long id) {
-        bool encontrado = false;
-        for (auto& rm : diccionarioDeDatosEnRAM) {
-            if (rm.idRegistro == id) {
-                if (rm.ocupado) {
-                    rm.ocupado = false; // Marcamos como no ocupado
-                    encontrado = true;
-                    cout << "Registro ID " << id << " marcado como eliminado (lógicamente)." << endl;
-                } else {
-                    cout << "Registro ID " << id << " ya está eliminado." << endl;
-                }
-                break;
+    // Busca los registros que cumplen "columna operador valor" (operadores: = != > >= < <=).
+    // Usa los zone maps para saltar los sectores que no pueden contener coincidencias.
+    // Con usarZonas = false se leen todos los sectores de la tabla (referencia para
+    // comprobar que la poda por zone maps no cambia el resultado).
+    vector<pair<long, string>> escanearPorValor(const string& nombreColumna, const string& operador, const string& valor,
+                                                int& sectoresLeidos, int& sectoresDescartados, bool usarZonas = true) {
+        METRICA_MEDIR(OP_ESCANEAR);
+        vector<pair<long, string>> resultados;
+        sectoresLeidos = 0;
+        sectoresDescartados = 0;
+
+        Tabla* tabla = getTablaActiva();
+        if (tabla == nullptr) {
+            cerr << "Error: No hay tabla activa." << endl;
+            return resultados;
+        }
+        vector<string> columnas = dividirCampos(tabla->esquema);
+        auto itCol = find(columnas.begin(), columnas.end(), nombreColumna);
+        if (itCol == columnas.end()) {
+            cerr << "Error: La columna '" << nombreColumna << "' no existe en el esquema." << endl;
+            return resultados;
+        }
+        int columna = itCol - columnas.begin();
+
+        // Primero descartar sectores con los zone maps; solo se agrupan los metadatos de
+        // los registros que están en sectores candidatos
+        vector<bool> candidato(getTotalSectores(), false);
+        for (int idx = 0; idx < getTotalSectores(); ++idx) {
+            if (propietarioSector[idx] != tabla->id) continue;
+            if (!usarZonas) {
+                candidato[idx] = true;
+            } else if (zonasSectores[idx].numRegistros == 0) {
+                continue;
+            } else if (zonaPuedeCoincidir(zonasSectores[idx], columna, operador, valor)) {
+                candidato[idx] = true;
+            } else {
+                sectoresDescartados++;
+            }
+        }
+        // Leer solo los sectores candidatos, con memoria acotada (un shard de metadatos a la vez)
+        sectoresLeidos = recorrerPorSectores(*tabla, [&](int idx) { return (bool)candidato[idx]; },
+                                             [&](const RecordMetadata& rm, const string& fisico) {
+            string registro = decodificarRegistro(*tabla, fisico);
+            vector<string> campos = dividirCampos(registro);
+            if (columna < (int)campos.size() && cumpleCondicion(campos[columna], operador, valor)) {
+                resultados.push_back({rm.idRegistro, registro});
             }
+        });
+        sort(resultados.begin(), resultados.end());
+        return resultados;
+    }
+
+    // Elimina un registro por su ID (marcando como no ocupado). Devuelve true si se eliminó.
+    bool eliminarRegistro(long id) {
+        METRICA_MEDIR(OP_ELIMINAR);
+        Tabla* tabla = getTablaActiva();
+        if (tabla == nullptr) {
+            cerr << "Error: No hay tabla activa." << endl;
+            return false;
         }
-        if (!encontrado) {
-            cout << "Registro ID " << id << " no encontrado." << endl;
+        RecordMetadata rm;
+        bool encontrado = obtenerRegistro(*tabla, id, rm);
+        if (encontrado) {
+            borrarRegistro(*tabla, id); // Baja lógica: los bytes quedan en el sector
+            tabla->numVivos--;
+            if (tabla->bytesVivos >= 0) {
+                for (const Extension& e : fragmentosDe(rm)) tabla->bytesVivos -= e.tam;
+            }
+            if (!silencioso) cout << "Registro ID " << id << " marcado como eliminado (lógicamente).\n";
+        } else if (!silencioso) {
+            // Los IDs son consecutivos: uno menor que siguienteId existió y fue eliminado
+            if (id >= 1 && id < tabla->siguienteId) {
+                cout << "Registro ID " << id << " ya está eliminado." << endl;
+            } else {
+                cout << "Registro ID " << id << " no encontrado." << endl;
+            }
         }
         persistirDiccionario(); // Persistir el cambio
+        return encontrado;
     }
 
     // Muestra el mapa de bits de sectores ocupados/libres (simplificado)
     void mostrarMapaDeBits() {
+        // Sectores con al menos un fragmento de un registro vivo (una pasada por los shards)
+        vector<bool> conRegistros(getTotalSectores(), false);
+        for (const Tabla& tabla : tablas) {
+            recorrerEntradas(tabla, [&](const RecordMetadata& rm) {
+                for (const Extension& e : fragmentosDe(rm)) {
+                    conRegistros[indiceSector(e.platoIdx, e.superficieIdx, e.pistaIdx, e.sectorGlobalEnPista)] = true;
+                }
+            });
+        }
+
         cout << "\n--- Mapa de Asignación de Sectores ---\n";
         for (int p = 0; p < numPlatos; ++p) {
             cout << "Plato " << p << ":\n";
@@ -658,13 +3477,7 @@ public:
                             Sector* sectorObj = pistaObj->getSector(sec);
                             if (sectorObj) {
                                 if (sectorObj->obtenerTamArchivo() < sectorObj->getCapacidadBytes()) {
-                                    bool tieneEspacio = false;
-                                    for(const auto& rm : diccionarioDeDatosEnRAM) {
-                                        if(rm.platoIdx == p && rm.superficieIdx == s && rm.pistaIdx == t && rm.sectorGlobalEnPista == sec && rm.ocupado) {
-                                            tieneEspacio = true; // Si hay al menos un registro ocupado, se considera con datos
-                                            break;
-                                        }
-                                    }
+                                    bool tieneEspacio = conRegistros[indiceSector(p, s, t, sec)];
                                     if(tieneEspacio) {
                                          cout << "O"; // Ocupado (tiene algún registro)
                                     } else {
@@ -704,33 +3517,770 @@ public:
     }
 
     void mostrarEstadoDiccionario() {
-        if (diccionarioDeDatosEnRAM.empty()) {
-            cout << "Diccionario de datos en RAM está vacío.\n";
+        Tabla* tabla = getTablaActiva();
+        if (tabla == nullptr || tabla->numVivos == 0) {
+            cout << "Diccionario de datos vacío.\n";
             return;
         }
-        cout << "\n--- Estado del Diccionario de Datos en RAM ---\n";
+        cout << "\n--- Estado del Diccionario de Datos (tabla " << tabla->nombre << ") ---\n";
         cout << setw(5) << "ID" << setw(8) << "Plato" << setw(10) << "Superf."
              << setw(7) << "Pista" << setw(8) << "Sector" << setw(8) << "Offset"
-             << setw(7) << "Tam." << setw(8) << "Ocupado" << endl;
-        cout << string(60, '-') << endl;
-        for (const auto& rm : diccionarioDeDatosEnRAM) {
+             << setw(7) << "Tam." << setw(8) << "Ocupado" << setw(6) << "Frag." << endl;
+        cout << string(66, '-') << endl;
+        recorrerEntradas(*tabla, [](const RecordMetadata& rm) {
             cout << setw(5) << rm.idRegistro << setw(8) << rm.platoIdx << setw(10) << rm.superficieIdx
                  << setw(7) << rm.pistaIdx << setw(8) << rm.sectorGlobalEnPista << setw(8) << rm.offset
-                 << setw(7) << rm.tamRegistro << setw(8) << (rm.ocupado ? "Si" : "No") << endl;
-        }
+                 << setw(7) << rm.tamRegistro << setw(8) << (rm.ocupado ? "Si" : "No")
+                 << setw(6) << 1 + rm.extensiones.size() << "\n";
+        });
         cout << "-----------------------------------------------\n";
+        mostrarEstadoShards(cout);
+    }
+
+    // Muestra la razón de compresión y el costo de lectura/escritura de la codificación
+    void mostrarReporteCompresion() {
+        cout << "\n--- Reporte de Compresión ---\n";
+        cout << "Modo: " << modoCompresion << "\n";
+        size_t entradasValores = 0;
+        for (const Tabla& tabla : tablas) entradasValores += tabla.valoresDiccionario.size();
+        cout << "Entradas en el diccionario de valores: " << entradasValores << "\n";
+
+        long long bytesFisicos = 0, bytesLogicos = 0;
+        long long nanosLectura = 0, nanosDecodificacion = 0;
+        int registros = 0;
+        for (const Tabla& tabla : tablas) {
+            recorrerEntradas(tabla, [&](const RecordMetadata& rm) {
+                auto t0 = chrono::steady_clock::now();
+                string fisico = leerRegistroFisico(rm);
+                auto t1 = chrono::steady_clock::now();
+                string logico = decodificarRegistro(tabla, fisico);
+                auto t2 = chrono::steady_clock::now();
+
+                nanosLectura += chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count();
+                nanosDecodificacion += chrono::duration_cast<chrono::nanoseconds>(t2 - t1).count();
+                for (const Extension& e : fragmentosDe(rm)) bytesFisicos += e.tam;
+                bytesLogicos += logico.length() + 1;
+                registros++;
+            });
+        }
+
+        if (registros == 0) {
+            cout << "No hay registros almacenados.\n";
+            cout << "-----------------------------\n";
+            return;
+        }
+
+        // MB/s = bytes / ns * 1e9 / 2^20
+        auto mbPorSeg = [](long long bytes, long long nanos) {
+            return nanos > 0 ? (double)bytes * 1e9 / nanos / (1024.0 * 1024.0) : 0.0;
+        };
+        cout << fixed << setprecision(2);
+        cout << "Registros: " << registros << "\n";
+        cout << "Bytes lógicos: " << bytesLogicos << "  Bytes en disco: " << bytesFisicos << "\n";
+        cout << "Razón de compresión: " << (double)bytesLogicos / bytesFisicos << "x ("
+             << 100.0 * (1.0 - (double)bytesFisicos / bytesLogicos) << "% ahorrado)\n";
+        cout << "Lectura desde sectores: " << mbPorSeg(bytesFisicos, nanosLectura) << " MB/s\n";
+        cout << "Decodificación: " << mbPorSeg(bytesLogicos, nanosDecodificacion) << " MB/s ("
+             << 100.0 * nanosDecodificacion / (nanosLectura + nanosDecodificacion) << "% del tiempo de lectura)\n";
+        if (bytesLogicosEscritos > 0) {
+            cout << "Codificación (esta sesión): " << mbPorSeg(bytesLogicosEscritos, nanosCodificacion) << " MB/s, "
+                 << bytesLogicosEscritos << " -> " << bytesFisicosEscritos << " bytes\n";
+        }
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+        cout << "-----------------------------\n";
+    }
+
+    void setSilencioso(bool valor) {
+        silencioso = valor;
+    }
+
+    // Cambia la tabla sobre la que operan insertar, recuperar, eliminar y escanear
+    bool seleccionarTabla(const string& nombre) {
+        Tabla* tabla = buscarTabla(nombre);
+        if (tabla == nullptr) {
+            cerr << "Error: La tabla '" << nombre << "' no existe." << endl;
+            return false;
+        }
+        tablaActiva = tabla - &tablas[0];
+        return true;
+    }
+
+    void listarTablas(ostream& out) const {
+        if (tablas.empty()) {
+            out << "No hay tablas en el catálogo.\n";
+            return;
+        }
+        for (size_t i = 0; i < tablas.size(); ++i) {
+            const Tabla& t = tablas[i];
+            long sectores = count(propietarioSector.begin(), propietarioSector.end(), t.id);
+            out << ((int)i == tablaActiva ? "* " : "  ") << t.nombre << " (id " << t.id << "): "
+                << t.numVivos << " registros, " << sectores << " sectores, esquema " << t.esquema << "\n";
+        }
+    }
+
+    void mostrarEstadoShards(ostream& out) const {
+        out << "Shards del diccionario: " << shards->getResidentes() << " residentes, " << shards->getCargas()
+            << " cargas, " << shards->getDesalojos() << " desalojos; desbordados: "
+            << shardsDesbordados->getResidentes() + shardsFragmentos->getResidentes() << " residentes, "
+            << shardsDesbordados->getCargas() + shardsFragmentos->getCargas() << " cargas; memoria "
+            << (presupuestoShards.bytesResidentes + 1023) / 1024 << " KB de " << presupuestoShards.bytesMaximos / 1024 << " KB\n";
+    }
+
+    // Presupuesto de memoria de los shards residentes del diccionario (MEMORIA_SHARDS_DEFECTO
+    // por omisión). Si baja, los shards sobrantes se desalojan en el momento.
+    void setMemoriaShards(size_t bytes) {
+        presupuestoShards.bytesMaximos = bytes;
+        shards->ajustar();
+        shardsDesbordados->ajustar();
+        shardsFragmentos->ajustar();
+    }
+
+    size_t getMemoriaShardsResidente() const { return presupuestoShards.bytesResidentes; }
+
+    // Verificación y reparación del disco (fsck). Los sectores de datos se leen en paralelo
+    // con 'hilos' hilos para ubicar sus registros completos; luego cada entrada del
+    // diccionario se contrasta con esos límites (offset y tamaño exactos, sin dos IDs sobre
+    // el mismo registro) y se buscan los registros que ninguna entrada referencia.
+    // Con 'reparar' se descartan las entradas inválidas, se truncan los registros
+    // incompletos al final de los sectores, se corrigen contadores y secuencias de IDs y se
+    // recalcula el espacio libre (dueño de cada sector) y los zone maps. Con 'reconstruir'
+    // además se dan de alta, con IDs nuevos, los registros sin entrada: así se recupera un
+    // diccionario perdido (shards o Sector1) a partir del contenido de los sectores.
+    // Los registros repartidos en varios sectores se rearman con las cabeceras de sus
+    // fragmentos de continuación (conservan su ID si su entrada sigue en el shard); un
+    // fragmento de continuación nunca se da de alta solo y una cadena incompleta no se
+    // recupera. En discos anteriores a las cabeceras, los fragmentos no se pueden reencadenar.
+    InformeVerificacion verificarDisco(bool reparar, bool reconstruir, int hilos = 0) {
+        METRICA_MEDIR(OP_VERIFICAR);
+        InformeVerificacion inf;
+        if (reconstruir) reparar = true;
+        if (hilos <= 0) hilos = max(1u, thread::hardware_concurrency());
+        inf.hilos = hilos;
+        inf.lineasMetadatosInvalidas = lineasMetadatosInvalidas;
+        int total = getTotalSectores();
+        auto inicio = chrono::steady_clock::now();
+
+        // Fase 1 (paralela): límites de los registros de cada sector. Cada hilo procesa
+        // bloques de sectores consecutivos y solo escribe en sus propias posiciones.
+        vector<LineasSector> sectores(total);
+        atomic<long long> bytesLeidos(0);
+        int bloques = min(total, hilos * 8);
+        ejecutarEnParalelo(bloques, hilos, [&](int b) {
+            for (int idx = (long)b * total / bloques; idx < (long)(b + 1) * total / bloques; ++idx) {
+                if (idx < 2) continue; // Sector0 y Sector1 son reservados
+                string contenido = sectorPorIndice(idx)->leerTodo();
+                LineasSector& ls = sectores[idx];
+                ls.tam = contenido.size();
+                for (size_t pos = 0; pos < contenido.size();) {
+                    size_t fin = contenido.find('\n', pos);
+                    if (fin == string::npos) break;
+                    CabeceraContinuacion cabecera;
+                    size_t largo = leerCabeceraContinuacion(contenido, pos, fin, cabecera);
+                    if (largo > 0) ls.continuaciones.push_back({(int)ls.inicios.size(), (int)largo, cabecera});
+                    ls.inicios.push_back(pos);
+                    pos = fin + 1;
+                    ls.finDatos = pos;
+                }
+                ls.duenos.assign(ls.inicios.size(), {SIN_PROPIETARIO, 0});
+                bytesLeidos += contenido.size();
+            }
+        });
+        inf.sectoresLeidos = max(0, total - 2);
+        inf.bytesLeidos = bytesLeidos;
+        inf.segundosLectura = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+        // Posición del registro del sector que coincide exactamente con el fragmento (-1 si ninguno)
+        auto buscarRegistro = [&](const Extension& e, int& idx) -> int {
+            if (!ubicacionValida(e)) return -1;
+            idx = indiceSector(e.platoIdx, e.superficieIdx, e.pistaIdx, e.sectorGlobalEnPista);
+            const LineasSector& ls = sectores[idx];
+            auto it = lower_bound(ls.inicios.begin(), ls.inicios.end(), e.offset);
+            if (it == ls.inicios.end() || *it != e.offset) return -1;
+            int r = it - ls.inicios.begin();
+            return ls.tamRegistro(r) == e.tam ? r : -1;
+        };
+
+        // Fragmentos de continuación agrupados por la ubicación (lba, offset) de su primer fragmento
+        struct Eslabon {
+            int idx;
+            int registro;
+            int largoCabecera;
+            CabeceraContinuacion cabecera;
+        };
+        auto claveCadena = [](long lba, long offset) { return ((long long)lba << 32) | (offset & 0xFFFFFFFFLL); };
+        unordered_map<long long, vector<Eslabon>> cadenas;
+        for (int idx = 2; idx < total; ++idx) {
+            for (const auto& c : sectores[idx].continuaciones) {
+                cadenas[claveCadena(c.cabecera.lbaPrimero, c.cabecera.offsetPrimero)].push_back(
+                    {idx, c.registro, c.largoCabecera, c.cabecera});
+            }
+        }
+
+        // Rearma un registro repartido a partir de su primer fragmento (registro r del sector
+        // idx) y las cabeceras de continuación: los fragmentos, sin dueño, deben cubrir todos
+        // los datos sin huecos. Devuelve false si el registro no está repartido o la cadena
+        // está incompleta.
+        auto reencadenar = [&](int idx, int r, RecordMetadata& rm) -> bool {
+            const LineasSector& cabeza = sectores[idx];
+            if (cabeza.esContinuacion(r)) return false;
+            auto it = cadenas.find(claveCadena(idx, cabeza.inicios[r]));
+            if (it == cadenas.end()) return false;
+            vector<Extension> extensiones;
+            long posicion = cabeza.tamRegistro(r) - 1;
+            long totalDatos = -1;
+            while (totalDatos < 0 || posicion < totalDatos) {
+                const Eslabon* siguiente = nullptr;
+                for (const Eslabon& e : it->second) {
+                    if (e.cabecera.posicion == posicion && (totalDatos < 0 || e.cabecera.total == totalDatos) &&
+                        sectores[e.idx].duenos[e.registro].second == 0) {
+                        siguiente = &e;
+                        break;
+                    }
+                }
+                if (siguiente == nullptr) return false;
+                totalDatos = siguiente->cabecera.total;
+                const LineasSector& ls = sectores[siguiente->idx];
+                Extension ext;
+                ubicacionSector(siguiente->idx, ext.platoIdx, ext.superficieIdx, ext.pistaIdx, ext.sectorGlobalEnPista);
+                ext.offset = ls.inicios[siguiente->registro];
+                ext.tam = ls.tamRegistro(siguiente->registro);
+                extensiones.push_back(ext);
+                posicion += ext.tam - 1 - siguiente->largoCabecera;
+            }
+            if (posicion != totalDatos) return false;
+            ubicacionSector(idx, rm.platoIdx, rm.superficieIdx, rm.pistaIdx, rm.sectorGlobalEnPista);
+            rm.offset = cabeza.inicios[r];
+            rm.tamRegistro = cabeza.tamRegistro(r);
+            rm.ocupado = true;
+            rm.extensiones = extensiones;
+            return true;
+        };
+
+        // Un diccionario perdido deja shards de tablas que ya no están en el catálogo
+        if (reconstruir) {
+            int maxId = 0;
+            for (const Tabla& t : tablas) maxId = max(maxId, t.id);
+            for (int id = 0; id <= maxId + 16; ++id) {
+                if (buscarTablaPorId(id) == nullptr && shards->existeShard(id, 0)) {
+                    crearTabla("tabla" + to_string(id), "").id = id;
+                }
+            }
+        }
+
+        // Fase 2: contrastar las entradas de cada tabla con los registros de los sectores.
+        // Se recorren también los shards posteriores a siguienteId (Sector1 desactualizado).
+        vector<vector<long>> descartadas(tablas.size());
+        vector<vector<RecordMetadata>> reencadenados(tablas.size()); // Desbordados sin metadatos, rearmados
+        vector<long> ultimoId(tablas.size(), 0);
+        vector<long> vivos(tablas.size(), 0);
+        vector<EntradaDiccionario> copia;
+        for (size_t ti = 0; ti < tablas.size(); ++ti) {
+            Tabla& tabla = tablas[ti];
+            long numShards = (tabla.siguienteId - 1 + ENTRADAS_POR_SHARD - 1) / ENTRADAS_POR_SHARD;
+            for (long n = 0; n < numShards || shards->existeShard(tabla.id, n); ++n) {
+                if (!shards->copiarShard(tabla.id, n, copia)) continue;
+                for (long i = 0; i < ENTRADAS_POR_SHARD; ++i) {
+                    const EntradaDiccionario& entrada = copia[i];
+                    long id = n * ENTRADAS_POR_SHARD + i + 1;
+                    if (entrada.flags == 0 && entrada.tam == 0) continue; // ID sin usar
+                    bool ocupada = entrada.flags & ENTRADA_OCUPADA;
+
+                    RecordMetadata rm;
+                    bool valida = entrada.lba < (uint64_t)total;
+                    if (entrada.flags & ENTRADA_DESBORDADA) {
+                        if (!leerDesbordado(tabla, id, rm)) {
+                            // Sin sus metadatos (shards _D/_F perdidos): rearmarlo desde el primer fragmento
+                            int idx = -1, r = -1;
+                            if (valida && entrada.tam > 0) {
+                                Extension primero;
+                                ubicacionSector((long)entrada.lba, primero.platoIdx, primero.superficieIdx,
+                                                primero.pistaIdx, primero.sectorGlobalEnPista);
+                                primero.offset = entrada.offset;
+                                primero.tam = entrada.tam;
+                                r = buscarRegistro(primero, idx);
+                            }
+                            valida = r >= 0 && reencadenar(idx, r, rm);
+                            if (valida) {
+                                rm.idRegistro = id;
+                                if (ocupada) {
+                                    reencadenados[ti].push_back(rm);
+                                    inf.registrosReencadenados++;
+                                }
+                            }
+                        }
+                    } else if (valida) {
+                        desempaquetar(id, entrada, rm);
+                    }
+
+                    // Cada fragmento debe ser un registro completo que ningún otro ID vivo use
+                    vector<pair<int, int>> ubicados;
+                    bool duplicada = false;
+                    for (const Extension& e : valida ? fragmentosDe(rm) : vector<Extension>()) {
+                        int idx = -1;
+                        int r = buscarRegistro(e, idx);
+                        if (r < 0) {
+                            valida = false;
+                        } else if (sectores[idx].duenos[r].second > 0) {
+                            valida = false;
+                            duplicada = true;
+                        }
+                        if (!valida) break;
+                        ubicados.push_back({idx, r});
+                    }
+
+                    if (!ocupada) {
+                        // Registro eliminado: sus líneas siguen en los sectores pero no son huérfanas.
+                        // La entrada solo conserva el primer fragmento; el resto sale de la cadena.
+                        RecordMetadata cadena;
+                        if (valida && ubicados.size() == 1 && reencadenar(ubicados[0].first, ubicados[0].second, cadena)) {
+                            for (const Extension& e : cadena.extensiones) {
+                                int idx = -1;
+                                int r = buscarRegistro(e, idx);
+                                if (r >= 0) ubicados.push_back({idx, r});
+                            }
+                        }
+                        for (const auto& u : valida ? ubicados : vector<pair<int, int>>()) {
+                            if (sectores[u.first].duenos[u.second].second == 0) {
+                                sectores[u.first].duenos[u.second] = {tabla.id, -1};
+                            }
+                        }
+                        ultimoId[ti] = max(ultimoId[ti], id);
+                        continue;
+                    }
+                    if (!valida) {
+                        (duplicada ? inf.entradasDuplicadas : inf.entradasInvalidas)++;
+                        descartadas[ti].push_back(id);
+                        continue;
+                    }
+                    for (const auto& u : ubicados) sectores[u.first].duenos[u.second] = {tabla.id, id};
+                    inf.registrosValidos++;
+                    vivos[ti]++;
+                    ultimoId[ti] = max(ultimoId[ti], id);
+                    if (id >= tabla.siguienteId) inf.entradasFueraDeSecuencia++;
+                }
+            }
+            if (vivos[ti] != tabla.numVivos) inf.contadoresIncorrectos++;
+        }
+
+        // Registros sin entrada y registros incompletos al final de cada sector
+        for (int idx = 2; idx < total; ++idx) {
+            LineasSector& ls = sectores[idx];
+            if (ls.tam > ls.finDatos) inf.colasTruncadas++;
+            if (ls.tam > capacidadSectorBytes) inf.sectoresSobreCapacidad++;
+            for (const auto& d : ls.duenos) {
+                if (d.second == 0) inf.registrosSinEntrada++;
+            }
+        }
+
+        if (reparar) {
+            for (size_t ti = 0; ti < tablas.size(); ++ti) {
+                Tabla& tabla = tablas[ti];
+                for (long id : descartadas[ti]) {
+                    EntradaDiccionario* entrada = shards->escribir(tabla.id, id);
+                    if (entrada != nullptr) *entrada = EntradaDiccionario(); // Sin rastro: no apunta a nada
+                }
+                for (const RecordMetadata& rm : reencadenados[ti]) guardarRegistro(tabla, rm);
+                // Sin ninguna entrada (diccionario perdido) la numeración vuelve a empezar para que
+                // los IDs reconstruidos sigan el orden de carga
+                bool sinEntradas = ultimoId[ti] == 0 && descartadas[ti].empty();
+                tabla.siguienteId = (reconstruir && sinEntradas) ? 1 : max(tabla.siguienteId, ultimoId[ti] + 1);
+                tabla.numVivos = vivos[ti];
+                tabla.bytesVivos = -1;
+            }
+
+            // Dar de alta los registros sin entrada en el orden en que encontrarEspacioCilindrico
+            // recorre el disco (así una carga se recupera con sus IDs originales): en la tabla
+            // dueña del sector o, si no tiene, en la primera tabla
+            if (reconstruir && inf.registrosSinEntrada > 0) {
+                if (tablas.empty()) {
+                    crearTabla("recuperada", "");
+                    tablaActiva = 0;
+                }
+                for (int p = 0; p < numPlatos; ++p) {
+                    for (int t = 0; t < numPistasPorSuperficie; ++t) {
+                        for (int s = 0; s < numSuperficiesPorPlato; ++s) {
+                            for (int sec = 0; sec < numSectoresPorPista; ++sec) {
+                                int idx = indiceSector(p, s, t, sec);
+                                LineasSector& ls = sectores[idx];
+                                Tabla* tabla = buscarTablaPorId(propietarioSector[idx]);
+                                if (tabla == nullptr) tabla = &tablas[0];
+                                for (size_t r = 0; r < ls.inicios.size(); ++r) {
+                                    // Un fragmento de continuación nunca es un registro: se da de
+                                    // alta junto con su primer fragmento
+                                    if (ls.duenos[r].second != 0 || ls.esContinuacion(r)) continue;
+                                    RecordMetadata rm;
+                                    rm.idRegistro = tabla->siguienteId;
+                                    if (cadenas.count(claveCadena(idx, ls.inicios[r]))) {
+                                        if (!reencadenar(idx, r, rm)) {
+                                            inf.cadenasIncompletas++;
+                                            continue;
+                                        }
+                                        inf.registrosReencadenados++;
+                                    } else {
+                                        rm.platoIdx = p;
+                                        rm.superficieIdx = s;
+                                        rm.pistaIdx = t;
+                                        rm.sectorGlobalEnPista = sec;
+                                        rm.offset = ls.inicios[r];
+                                        rm.tamRegistro = ls.tamRegistro(r);
+                                        rm.ocupado = true;
+                                    }
+                                    if (!guardarRegistro(*tabla, rm)) continue;
+                                    tabla->siguienteId++;
+                                    tabla->numVivos++;
+                                    for (const Extension& e : fragmentosDe(rm)) {
+                                        int idxFragmento = indiceSector(e.platoIdx, e.superficieIdx, e.pistaIdx, e.sectorGlobalEnPista);
+                                        LineasSector& fragmento = sectores[idxFragmento];
+                                        int rf = lower_bound(fragmento.inicios.begin(), fragmento.inicios.end(), e.offset) - fragmento.inicios.begin();
+                                        fragmento.duenos[rf] = {tabla->id, rm.idRegistro};
+                                    }
+                                    inf.registrosRecuperados++;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Espacio libre: un sector pertenece a la tabla de sus registros; uno sin registros
+        // queda libre. Los sectores con registros sin entrada conservan su dueño.
+        for (int idx = 2; idx < total; ++idx) {
+            int dueno = SIN_PROPIETARIO;
+            bool huerfanos = false;
+            for (const auto& d : sectores[idx].duenos) {
+                if (d.second == 0) {
+                    huerfanos = true;
+                } else if (dueno == SIN_PROPIETARIO) {
+                    dueno = d.first;
+                }
+            }
+            if (huerfanos && dueno == SIN_PROPIETARIO) dueno = propietarioSector[idx];
+            if (dueno == propietarioSector[idx]) continue;
+            (dueno == SIN_PROPIETARIO ? inf.sectoresLiberados : inf.sectoresReasignados)++;
+            if (reparar) reclamarSector(idx, dueno);
+        }
+
+        if (reparar) {
+            // Truncar los registros incompletos: ninguna entrada válida los referencia
+            for (int idx = 2; idx < total; ++idx) {
+                if (sectores[idx].tam <= sectores[idx].finDatos) continue;
+                Sector* sector = sectorPorIndice(idx);
+                sector->escribir(sector->leerTodo().substr(0, sectores[idx].finDatos), true);
+            }
+            reconstruirZonas();
+            catalogoModificado = true; // Reescribir también Sector0 (puede tener líneas dañadas)
+            persistirDiccionario();
+            lineasMetadatosInvalidas = 0;
+            inf.reparado = true;
+        }
+        inf.segundosTotal = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+        return inf;
+    }
+
+    string getNombreTablaActiva() const {
+        return tablaActiva >= 0 ? tablas[tablaActiva].nombre : "";
     }
 
     string getTablaEsquema() const {
-        return tablaEsquema;
+        return tablaActiva >= 0 ? tablas[tablaActiva].esquema : "";
     }
     int getNumPlatos() const { return numPlatos; }
     int getNumSuperficiesPorPlato() const { return numSuperficiesPorPlato; }
     int getNumPistasPorSuperficie() const { return numPistasPorSuperficie; }
     int getNumSectoresPorPista() const { return numSectoresPorPista; }
     int getCapacidadSectorBytes() const { return capacidadSectorBytes; }
+    string getRutaBaseDisco() const { return rutaBaseDisco; }
+
+    long getNumRegistros() const {
+        return tablaActiva >= 0 ? tablas[tablaActiva].numVivos : 0;
+    }
+};
+
+// Intérprete de comandos para el modo no interactivo (script, stdin o traza).
+// Cada línea es un comando; las líneas vacías y las que empiezan con '#' se ignoran.
+//   create <nombre> <platos> <superficies> <pistas> <sectores> <capacidad> [dict]
+//   open <ruta>            load <csv> [tabla]    insert <campo#campo#...>
+//   loadsorted <csv> <columna> [tabla|-] [memoriaKB]
+//   join <tablaIzq> <colIzq> <tablaDer> <colDer> [hash|merge] [memoriaKB] [hilos]
+//   table <nombre>         tables
+//   get <id>               del <id>              scan <columna> <op> <valor>
+//   fsck [reparar|reconstruir] [hilos]
+//   recover <nombre> <platos> <superficies> <pistas> <sectores> <capacidad> [dict|-] [hilos]
+//   stats                  quiet on|off          replay <archivo>
+//   shardmem <memoriaKB>   (shards del diccionario residentes; vale también para los discos que se abran después)
+class InterpreteComandos {
+private:
+    Disco* disco;
+    ostream& salida;
+    bool silencioso;
+    ofstream traza;
+    long comandosEjecutados;
+    long errores;
+    int profundidadReplay; // Evita bucles infinitos de replay
+    size_t memoriaShards;  // Presupuesto de shards de los discos que se abren (shardmem)
+
+    void error(const string& mensaje) {
+        errores++;
+        cerr << "ERROR: " << mensaje << "\n";
+    }
+
+    bool requiereDisco(const string& comando) {
+        if (disco == nullptr) {
+            error(comando + ": no hay disco abierto (use create u open)");
+            return false;
+        }
+        return true;
+    }
+
+    void registrarTraza(const string& linea) {
+        if (traza.is_open()) traza << linea << "\n";
+    }
+
+public:
+    InterpreteComandos(ostream& out, bool modoSilencioso)
+        : disco(nullptr), salida(out), silencioso(modoSilencioso), comandosEjecutados(0), errores(0), profundidadReplay(0),
+          memoriaShards(MEMORIA_SHARDS_DEFECTO) {}
+
+    ~InterpreteComandos() {
+        delete disco;
+    }
+
+    // Registra los comandos ejecutados en un archivo para reproducirlos con 'replay'
+    bool abrirTraza(const string& ruta) {
+        traza.open(ruta, ios::trunc);
+        return traza.is_open();
+    }
+
+    long getErrores() const { return errores; }
+
+    // Código de salida del modo por lotes: 1 si algún comando falló
+    int codigoSalida() const { return errores > 0 ? 1 : 0; }
+    long getComandosEjecutados() const { return comandosEjecutados; }
+
+    void ejecutarFlujo(istream& entrada) {
+        string linea;
+        while (getline(entrada, linea)) {
+            if (!linea.empty() && linea.back() == '\r') linea.pop_back();
+            ejecutar(linea);
+        }
+    }
+
+    void ejecutar(const string& linea) {
+        size_t inicio = linea.find_first_not_of(" \t");
+        if (inicio == string::npos || linea[inicio] == '#') return;
+
+        stringstream ss(linea.substr(inicio));
+        string comando;
+        ss >> comando;
+        string resto;
+        getline(ss >> ws, resto);
+        comandosEjecutados++;
+
+        if (comando == "create") {
+            stringstream args(resto);
+            string nombre, compresion;
+            int nPlatos, nSuperficies, nPistas, nSectores, capSector;
+            if (!(args >> nombre >> nPlatos >> nSuperficies >> nPistas >> nSectores >> capSector)) {
+                error("uso: create <nombre> <platos> <superficies> <pistas> <sectores> <capacidad> [dict]");
+                return;
+            }
+            args >> compresion;
+            delete disco;
+            disco = new Disco(nPlatos, nSuperficies, nPistas, nSectores, capSector, nombre,
+                              compresion == "dict" ? COMPRESION_DICCIONARIO : COMPRESION_NINGUNA);
+            disco->setSilencioso(silencioso);
+            disco->setMemoriaShards(memoriaShards);
+            if (!silencioso) salida << "OK create " << disco->getRutaBaseDisco() << "\n";
+        } else if (comando == "open") {
+            delete disco;
+            disco = Disco::cargarDisco(resto, silencioso);
+            if (disco == nullptr) {
+                error("open: no se pudo cargar " + resto);
+                return;
+            }
+            disco->setMemoriaShards(memoriaShards);
+        } else if (comando == "load") {
+            if (!requiereDisco(comando)) return;
+            stringstream args(resto);
+            string rutaCSV, nombreTabla;
+            args >> rutaCSV >> nombreTabla;
+            if (!disco->cargarCSV(rutaCSV, nombreTabla)) {
+                error("load: la carga de " + rutaCSV + " no se completó");
+                return;
+            }
+            if (!silencioso) salida << "OK load " << rutaCSV << " -> " << disco->getNombreTablaActiva() << " ("
+                                    << disco->getNumRegistros() << " registros)\n";
+        } else if (comando == "loadsorted") {
+            if (!requiereDisco(comando)) return;
+            stringstream args(resto);
+            string rutaCSV, columna, nombreTabla;
+            long memoriaKB = 0;
+            args >> rutaCSV >> columna >> nombreTabla >> memoriaKB;
+            if (columna.empty()) {
+                error("uso: loadsorted <csv> <columna> [tabla] [memoriaKB]");
+                return;
+            }
+            if (nombreTabla == "-") nombreTabla = "";
+            size_t memoria = memoriaKB > 0 ? (size_t)memoriaKB * 1024 : MEMORIA_ORDENAMIENTO_DEFECTO;
+            if (!disco->cargarCSVOrdenado(rutaCSV, columna, nombreTabla, memoria)) {
+                error("loadsorted: la carga no se completó");
+                return;
+            }
+            if (!silencioso) salida << "OK loadsorted " << rutaCSV << " -> " << disco->getNombreTablaActiva() << " ("
+                                    << disco->getNumRegistros() << " registros)\n";
+        } else if (comando == "join") {
+            if (!requiereDisco(comando)) return;
+            stringstream args(resto);
+            string tablaIzq, columnaIzq, tablaDer, columnaDer, algoritmo = "hash";
+            long memoriaKB = 0;
+            int hilos = 0;
+            args >> tablaIzq >> columnaIzq >> tablaDer >> columnaDer >> algoritmo >> memoriaKB >> hilos;
+            if (columnaDer.empty()) {
+                error("uso: join <tablaIzq> <columnaIzq> <tablaDer> <columnaDer> [hash|merge] [memoriaKB] [hilos]");
+                return;
+            }
+            size_t memoria = memoriaKB > 0 ? (size_t)memoriaKB * 1024 : MEMORIA_ORDENAMIENTO_DEFECTO;
+            EstadisticasJoin est = disco->unirTablas(tablaIzq, columnaIzq, tablaDer, columnaDer, algoritmo,
+                                                     [&](const string& fila) { salida << fila << "\n"; }, memoria, hilos);
+            if (!est.ok) {
+                error("join: no se pudo unir " + tablaIzq + " con " + tablaDer);
+                return;
+            }
+            salida << "join: " << est.filas << " filas, " << est.algoritmo << ", " << est.particiones << " particiones, "
+                   << est.hilos << " hilos" << (est.derramado ? ", datos temporales en disco" : "")
+                   << (est.entradaOrdenada ? ", entrada ordenada" : "")
+                   << (est.reparticiones > 0 ? ", " + to_string(est.reparticiones) + " reparticiones" : "")
+                   << ", memoria máx. " << (est.memoriaMaxima + 1023) / 1024 << " KB\n";
+        } else if (comando == "shardmem") {
+            long memoriaKB = 0;
+            stringstream(resto) >> memoriaKB;
+            if (memoriaKB <= 0) {
+                error("uso: shardmem <memoriaKB>");
+                return;
+            }
+            memoriaShards = (size_t)memoriaKB * 1024;
+            if (disco) disco->setMemoriaShards(memoriaShards);
+        } else if (comando == "table") {
+            if (!requiereDisco(comando)) return;
+            if (!disco->seleccionarTabla(resto)) {
+                error("table: no existe la tabla " + resto);
+                return;
+            }
+        } else if (comando == "tables") {
+            if (!requiereDisco(comando)) return;
+            disco->listarTablas(salida);
+        } else if (comando == "insert") {
+            if (!requiereDisco(comando)) return;
+            if (!disco->insertarRegistro(resto)) {
+                error("insert: no se pudo insertar el registro");
+                return;
+            }
+        } else if (comando == "get") {
+            if (!requiereDisco(comando)) return;
+            long id = atol(resto.c_str());
+            string registro = disco->recuperarRegistro(id);
+            if (registro.empty()) {
+                error("get: registro " + to_string(id) + " no encontrado");
+                return;
+            }
+            salida << id << "\t" << registro << "\n";
+        } else if (comando == "del") {
+            if (!requiereDisco(comando)) return;
+            long id = atol(resto.c_str());
+            if (!disco->eliminarRegistro(id)) {
+                error("del: registro " + to_string(id) + " no encontrado");
+                return;
+            }
+        } else if (comando == "scan") {
+            if (!requiereDisco(comando)) return;
+            stringstream args(resto);
+            string columna, operador, valor;
+            args >> columna >> operador;
+            getline(args >> ws, valor);
+            if (columna.empty() || operador.empty()) {
+                error("uso: scan <columna> <op> <valor>");
+                return;
+            }
+            int leidos, descartados;
+            auto resultados = disco->escanearPorValor(columna, operador, valor, leidos, descartados);
+            for (const auto& r : resultados) salida << r.first << "\t" << r.second << "\n";
+            salida << "scan: " << resultados.size() << " registros, " << leidos << " sectores leídos, "
+                   << descartados << " descartados\n";
+        } else if (comando == "fsck") {
+            if (!requiereDisco(comando)) return;
+            stringstream args(resto);
+            string modo;
+            int hilos = 0;
+            if (!(args >> hilos)) { // El modo es opcional: "fsck 4" o "fsck reparar 4"
+                args.clear();
+                args.str(resto);
+                args >> modo >> hilos;
+            }
+            if (!modo.empty() && modo != "reparar" && modo != "reconstruir") {
+                error("uso: fsck [reparar|reconstruir] [hilos]");
+                return;
+            }
+            InformeVerificacion inf = disco->verificarDisco(modo == "reparar", modo == "reconstruir", hilos);
+            inf.mostrar(salida);
+            if (!inf.consistente() && !inf.reparado) {
+                error("fsck: el disco tiene inconsistencias (use fsck reparar o fsck reconstruir)");
+                return;
+            }
+        } else if (comando == "recover") {
+            stringstream args(resto);
+            string nombre, compresion;
+            int nPlatos, nSuperficies, nPistas, nSectores, capSector, hilos = 0;
+            if (!(args >> nombre >> nPlatos >> nSuperficies >> nPistas >> nSectores >> capSector) || nPlatos <= 0 ||
+                nSuperficies <= 0 || nPistas <= 0 || nSectores < 2 || capSector <= 0) {
+                error("uso: recover <nombre> <platos> <superficies> <pistas> <sectores> <capacidad> [dict|-] [hilos]");
+                return;
+            }
+            args >> compresion >> hilos;
+            delete disco;
+            InformeVerificacion inf;
+            disco = Disco::recuperarDisco(nPlatos, nSuperficies, nPistas, nSectores, capSector, nombre,
+                                          compresion == "dict" ? COMPRESION_DICCIONARIO : COMPRESION_NINGUNA,
+                                          inf, hilos, silencioso);
+            disco->setMemoriaShards(memoriaShards);
+            inf.mostrar(salida);
+        } else if (comando == "stats") {
+            if (!requiereDisco(comando)) return;
+            disco->listarTablas(salida);
+            disco->mostrarEstadoShards(salida);
+#ifndef DISCO_SIN_METRICAS
+            metricas().mostrar(salida);
+#endif
+        } else if (comando == "quiet") {
+            silencioso = (resto != "off");
+            if (disco) disco->setSilencioso(silencioso);
+            return; // No se registra en la traza
+        } else if (comando == "replay") {
+            ifstream archivo(resto);
+            if (!archivo.is_open()) {
+                error("replay: no se pudo abrir " + resto);
+                return;
+            }
+            if (profundidadReplay >= 8) {
+                error("replay: demasiados niveles anidados");
+                return;
+            }
+            profundidadReplay++;
+            ejecutarFlujo(archivo); // Los comandos reproducidos se registran individualmente
+            profundidadReplay--;
+            return;
+        } else {
+            error("comando desconocido: " + comando);
+            return;
+        }
+        registrarTraza(linea.substr(inicio));
+    }
 };
 
+// DISCO_SIN_MAIN permite incluir este archivo desde otras herramientas (ej. benchmark.cpp)
+#ifndef DISCO_SIN_MAIN
+
 // Función para mostrar el menú
 void mostrarMenu() {
     cout << "\n--- Sistema de Gestión de Almacenamiento ---\n";
@@ -743,10 +4293,76 @@ void mostrarMenu() {
     cout << "7. Mostrar mapa de bits de sectores\n";
     cout << "8. Mostrar estado del diccionario de datos\n";
     cout << "9. Salir\n";
+    cout << "10. Reporte de compresión\n";
+    cout << "11. Buscar registros por valor\n";
+    cout << "12. Mostrar/exportar métricas\n";
+    cout << "13. Listar/seleccionar tablas\n";
+    cout << "14. Carga masiva ordenada por columna\n";
+    cout << "15. Unir dos tablas (join)\n";
+    cout << "16. Verificar/reparar disco (fsck)\n";
     cout << "Ingrese su opción: ";
 }
 
-int main() {
+void mostrarUso() {
+    cout << "Uso: megatron                       (menú interactivo)\n"
+         << "     megatron [opciones] --script ARCHIVO | -   (modo por lotes; '-' lee de stdin)\n"
+         << "Opciones:\n"
+         << "  -q, --quiet       Omite los mensajes de confirmación (get y scan siguen mostrando resultados)\n"
+         << "  --trace ARCHIVO   Registra los comandos ejecutados para 'replay'\n"
+         << "  -c COMANDO        Ejecuta un comando (repetible, antes del script)\n"
+         << "Comandos: create, open, load, loadsorted, table, tables, join, insert, get, del, scan, fsck, recover, stats,\n"
+         << "          quiet, replay, shardmem\n";
+}
+
+// Modo no interactivo: sin prompts y con salida en búfer (un solo flush al final)
+int ejecutarModoLotes(int argc, char** argv) {
+    ios::sync_with_stdio(false);
+    bool silencioso = false;
+    string rutaScript, rutaTraza;
+    vector<string> comandos;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if ((arg == "-q" || arg == "--quiet")) {
+            silencioso = true;
+        } else if (arg == "--script" && i + 1 < argc) {
+            rutaScript = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            rutaTraza = argv[++i];
+        } else if (arg == "-c" && i + 1 < argc) {
+            comandos.push_back(argv[++i]);
+        } else {
+            mostrarUso();
+            return 2;
+        }
+    }
+
+    InterpreteComandos interprete(cout, silencioso);
+    if (!rutaTraza.empty() && !interprete.abrirTraza(rutaTraza)) {
+        cerr << "Error: No se pudo crear la traza " << rutaTraza << endl;
+        return 2;
+    }
+    for (const string& c : comandos) {
+        interprete.ejecutar(c);
+    }
+    if (rutaScript == "-") {
+        interprete.ejecutarFlujo(cin);
+    } else if (!rutaScript.empty()) {
+        ifstream script(rutaScript);
+        if (!script.is_open()) {
+            cerr << "Error: No se pudo abrir el script " << rutaScript << endl;
+            return 2;
+        }
+        interprete.ejecutarFlujo(script);
+    }
+    cout.flush();
+    return interprete.codigoSalida();
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return ejecutarModoLotes(argc, argv);
+    }
+
     Disco* disco = nullptr;
     int opcion;
 
@@ -755,7 +4371,11 @@ int main() {
 
     do {
         mostrarMenu();
-        cin >> opcion;
+        if (!(cin >> opcion)) {
+            if (cin.eof()) break; // Fin de la entrada: salir como con la opción 9
+            cin.clear();
+            opcion = -1;
+        }
         cin.ignore(numeric_limits<streamsize>::max(), '\n'); // Limpiar el buffer de entrada
 
         switch (opcion) {
@@ -776,11 +4396,16 @@ int main() {
                 cout << "Capacidad de cada sector (bytes): ";
                 cin >> capSector;
                 cin.ignore(numeric_limits<streamsize>::max(), '\n'); // Limpiar
+                string respuestaCompresion;
+                cout << "¿Activar compresión por diccionario? (s/n): ";
+                getline(cin, respuestaCompresion);
+                string compresion = (!respuestaCompresion.empty() && (respuestaCompresion[0] == 's' || respuestaCompresion[0] == 'S'))
+                                    ? COMPRESION_DICCIONARIO : COMPRESION_NINGUNA;
 
                 if (disco != nullptr) {
                     delete disco; // Liberar memoria del disco anterior si existe
                 }
-                disco = new Disco(nPlatos, nSuperficies, nPistas, nSectores, capSector, nombreDisco);
+                disco = new Disco(nPlatos, nSuperficies, nPistas, nSectores, capSector, nombreDisco, compresion);
 
                 int superficiesTotales = disco->getNumPlatos() * disco->getNumSuperficiesPorPlato();
                 long long totalSectores = (long long)disco->getNumPlatos() * disco->getNumSuperficiesPorPlato() * disco->getNumPistasPorSuperficie() * disco->getNumSectoresPorPista();
@@ -793,6 +4418,7 @@ int main() {
                 cout << "Sectores por pista: " << disco->getNumSectoresPorPista() << "\n";
                 cout << "Capacidad de sector: " << disco->getCapacidadSectorBytes() << " bytes\n";
                 cout << "Capacidad total del disco: " << capacidadTotalBytes << " bytes"<<endl;
+                cout << "Compresión: " << compresion << "\n";
                 cout << "===== ESTRUCTURA DE CARPETAS Y ARCHIVOS =====\n";
                 disco->mostrarArbol();
                 cout << "¡Disco creado exitosamente!\n";
@@ -819,7 +4445,10 @@ int main() {
                 string rutaCSV;
                 cout << "Ingrese la ruta del archivo CSV a cargar: ";
                 getline(cin, rutaCSV);
-                disco->cargarCSV(rutaCSV);
+                string nombreTabla;
+                cout << "Nombre de la tabla (Enter = nombre del archivo): ";
+                getline(cin, nombreTabla);
+                disco->cargarCSV(rutaCSV, nombreTabla);
                 break;
             }
             case 4: { // Insertar nuevo registro
@@ -887,6 +4516,154 @@ int main() {
                 break;
             }
 
+            case 10: { // Reporte de compresión
+                if (disco == nullptr) {
+                    cout << "Primero debe crear o cargar un disco (opción 1 o 2).\n";
+                    break;
+                }
+                disco->mostrarReporteCompresion();
+                break;
+            }
+
+            case 11: { // Buscar registros por valor
+                if (disco == nullptr) {
+                    cout << "Primero debe crear o cargar un disco (opción 1 o 2).\n";
+                    break;
+                }
+                cout << "Esquema actual: " << disco->getTablaEsquema() << "\n";
+                cout << "Ingrese la condición (columna operador valor), ej. 'price > 9000000': ";
+                string lineaCondicion, columna, operador, valor;
+                getline(cin, lineaCondicion);
+                stringstream ssCondicion(lineaCondicion);
+                ssCondicion >> columna >> operador;
+                getline(ssCondicion >> ws, valor);
+                if (columna.empty() || operador.empty()) {
+                    cout << "Condición inválida.\n";
+                    break;
+                }
+                int leidos, descartados;
+                auto resultados = disco->escanearPorValor(columna, operador, valor, leidos, descartados);
+                for (const auto& r : resultados) {
+                    cout << "ID " << r.first << ": " << r.second << "\n";
+                }
+                cout << resultados.size() << " registro(s) encontrados. Sectores leídos: " << leidos
+                     << ", sectores descartados por zone map: " << descartados << endl;
+                break;
+            }
+
+            case 12: { // Métricas
+#ifndef DISCO_SIN_METRICAS
+                metricas().mostrar(cout);
+                cout << "Exportar (j=JSON, p=Prometheus, r=reiniciar, otra tecla=no): ";
+                string respuesta;
+                getline(cin, respuesta);
+                if (respuesta == "r") {
+                    metricas().reiniciar();
+                    cout << "Métricas reiniciadas.\n";
+                } else if (respuesta == "j" || respuesta == "p") {
+                    cout << "Ruta del archivo de salida: ";
+                    string rutaMetricas;
+                    getline(cin, rutaMetricas);
+                    bool ok = (respuesta == "j") ? metricas().exportarJSON(rutaMetricas)
+                                                 : metricas().exportarPrometheus(rutaMetricas);
+                    cout << (ok ? "Métricas exportadas a " : "Error: no se pudo escribir ") << rutaMetricas << endl;
+                }
+#else
+                cout << "Métricas deshabilitadas en la compilación (DISCO_SIN_METRICAS).\n";
+#endif
+                break;
+            }
+
+            case 13: { // Tablas
+                if (disco == nullptr) {
+                    cout << "Primero debe crear o cargar un disco (opción 1 o 2).\n";
+                    break;
+                }
+                disco->listarTablas(cout);
+                cout << "Tabla a seleccionar (Enter = mantener " << disco->getNombreTablaActiva() << "): ";
+                string nombreTabla;
+                getline(cin, nombreTabla);
+                if (!nombreTabla.empty() && disco->seleccionarTabla(nombreTabla)) {
+                    cout << "Tabla activa: " << nombreTabla << endl;
+                }
+                break;
+            }
+
+            case 14: { // Carga ordenada
+                if (disco == nullptr) {
+                    cout << "Primero debe crear o cargar un disco (opción 1 o 2).\n";
+                    break;
+                }
+                string rutaCSV, columna, nombreTabla, memoria;
+                cout << "Ingrese la ruta del archivo CSV a cargar: ";
+                getline(cin, rutaCSV);
+                cout << "Columna por la que ordenar (ej. price, Age): ";
+                getline(cin, columna);
+                cout << "Nombre de la tabla (Enter = nombre del archivo): ";
+                getline(cin, nombreTabla);
+                cout << "Memoria para ordenar en KB (Enter = " << MEMORIA_ORDENAMIENTO_DEFECTO / 1024 << "): ";
+                getline(cin, memoria);
+                long memoriaKB = atol(memoria.c_str());
+                disco->cargarCSVOrdenado(rutaCSV, columna, nombreTabla,
+                                         memoriaKB > 0 ? (size_t)memoriaKB * 1024 : MEMORIA_ORDENAMIENTO_DEFECTO);
+                break;
+            }
+
+            case 15: { // Join
+                if (disco == nullptr) {
+                    cout << "Primero debe crear o cargar un disco (opción 1 o 2).\n";
+                    break;
+                }
+                disco->listarTablas(cout);
+                string tablaIzq, columnaIzq, tablaDer, columnaDer, algoritmo, rutaSalida;
+                cout << "Tabla izquierda: ";
+                getline(cin, tablaIzq);
+                cout << "Columna de la tabla izquierda: ";
+                getline(cin, columnaIzq);
+                cout << "Tabla derecha: ";
+                getline(cin, tablaDer);
+                cout << "Columna de la tabla derecha: ";
+                getline(cin, columnaDer);
+                cout << "Algoritmo (hash/merge, Enter = hash): ";
+                getline(cin, algoritmo);
+                if (algoritmo.empty()) algoritmo = "hash";
+                cout << "Archivo de salida (Enter = pantalla): ";
+                getline(cin, rutaSalida);
+
+                ofstream archivoSalida;
+                if (!rutaSalida.empty()) {
+                    archivoSalida.open(rutaSalida, ios::trunc);
+                    if (!archivoSalida.is_open()) {
+                        cout << "Error: no se pudo abrir " << rutaSalida << endl;
+                        break;
+                    }
+                }
+                ostream& destino = rutaSalida.empty() ? cout : archivoSalida;
+                EstadisticasJoin est = disco->unirTablas(tablaIzq, columnaIzq, tablaDer, columnaDer, algoritmo,
+                                                         [&](const string& fila) { destino << fila << "\n"; });
+                if (est.ok) {
+                    cout << est.filas << " fila(s) en " << fixed << setprecision(3) << est.segundos << " s ("
+                         << est.particiones << " particiones, " << est.hilos << " hilos"
+                         << (est.derramado ? ", datos temporales en disco" : "") << ")" << endl;
+                    cout.unsetf(ios::fixed);
+                    cout << setprecision(6);
+                }
+                break;
+            }
+
+            case 16: { // fsck
+                if (disco == nullptr) {
+                    cout << "Primero debe crear o cargar un disco (opción 1 o 2).\n";
+                    break;
+                }
+                cout << "Modo: v = solo verificar, r = reparar, c = reparar y reconstruir el diccionario (Enter = v): ";
+                string modo;
+                getline(cin, modo);
+                InformeVerificacion inf = disco->verificarDisco(modo == "r", modo == "c");
+                inf.mostrar(cout);
+                break;
+            }
+
             case 9: // Salir
                 cout << "Saliendo...\n";
                 break;
@@ -902,3 +4679,5 @@ int main() {
     }
     return 0;
 }
+
+#endif // DISCO_SIN_MAIN
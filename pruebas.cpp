@@ -0,0 +1,843 @@
+// Pruebas de regresión del motor de almacenamiento (clase Disco).
+//
+// Compilar:  g++ -std=c++17 -O2 pruebas.cpp -o pruebas
+// Ejecutar:  ./pruebas                 (todas las pruebas)
+//            ./pruebas zonas fsck      (solo las indicadas)
+//
+// Cada prueba trabaja en un directorio temporal propio (los discos se crean como
+// ./<nombre>_disk relativo al directorio actual) que se elimina al terminar.
+// El código de salida es 1 si alguna verificación falla.
+
+#define DISCO_SIN_MAIN
+#include "config.cpp"
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// ---------------------------------------------------------------------------
+// Infraestructura mínima
+// ---------------------------------------------------------------------------
+static long verificaciones = 0;
+static long fallos = 0;
+static string pruebaActual;
+
+static void verificar(bool ok, const string& descripcion, int linea) {
+    verificaciones++;
+    if (!ok) {
+        fallos++;
+        cerr << "FALLO [" << pruebaActual << "] línea " << linea << ": " << descripcion << "\n";
+    }
+}
+
+#define VERIFICAR(cond) verificar((cond), #cond, __LINE__)
+#define VERIFICAR_IGUAL(a, b) verificar((a) == (b), string(#a " == " #b " (") + aTexto(a) + " vs " + aTexto(b) + ")", __LINE__)
+
+template <typename T>
+static string aTexto(const T& valor) {
+    stringstream ss;
+    ss << valor;
+    return ss.str();
+}
+
+static string aTexto(const vector<pair<long, string>>& filas) {
+    stringstream ss;
+    ss << filas.size() << " filas";
+    return ss.str();
+}
+
+static void escribirArchivo(const string& ruta, const string& contenido) {
+    ofstream archivo(ruta, ios::trunc);
+    archivo << contenido;
+}
+
+static Disco* crearDisco(const string& nombre, int platos, int superficies, int pistas, int sectores, int capacidad,
+                         const string& compresion = COMPRESION_NINGUNA) {
+    Disco* disco = new Disco(platos, superficies, pistas, sectores, capacidad, nombre, compresion);
+    disco->setSilencioso(true);
+    return disco;
+}
+
+// ---------------------------------------------------------------------------
+// Zone maps: el resultado de un scan no depende de la poda (user-027)
+// ---------------------------------------------------------------------------
+static void pruebaZonas() {
+    VERIFICAR(esNumerico("3"));
+    VERIFICAR(esNumerico("-2.5"));
+    VERIFICAR(esNumerico("1e3"));
+    VERIFICAR(!esNumerico("nan"));
+    VERIFICAR(!esNumerico("inf"));
+    VERIFICAR(!esNumerico("0x10"));
+    VERIFICAR(!esNumerico(" 1"));
+    VERIFICAR(!esNumerico("1 "));
+    VERIFICAR(!esNumerico("1e999"));
+
+    // Valores mixtos: números con distinta escritura, texto y vacíos
+    stringstream csv;
+    csv << "id,k,age\n1,x,25\n2,3.0,\n3,y,40\n4,z,\n";
+    const char* textos[] = {"x", "y", "z", "abc", "3a"};
+    for (int i = 5; i <= 120; ++i) {
+        string k = (i % 4 == 0) ? textos[i % 5] : (i % 4 == 1 ? to_string(i % 7) : (i % 4 == 2 ? to_string(i % 7) + ".0" : ""));
+        string age = (i % 6 == 0) ? "" : (i % 9 == 0 ? "n/a" : to_string(18 + i % 50));
+        csv << i << "," << k << "," << age << "\n";
+    }
+    escribirArchivo("mixto.csv", csv.str());
+
+    Disco* disco = crearDisco("zonas", 1, 1, 8, 8, 128);
+    disco->cargarCSV("mixto.csv");
+    VERIFICAR_IGUAL(disco->getNumRegistros(), 120L);
+
+    int leidos, descartados;
+    auto k3 = disco->escanearPorValor("k", "=", "3", leidos, descartados);
+    VERIFICAR(!k3.empty() && k3[0].first == 2);
+    auto menores = disco->escanearPorValor("age", "<", "30", leidos, descartados);
+    VERIFICAR(!menores.empty() && menores[0].first == 1);
+    for (const auto& fila : menores) VERIFICAR(fila.first != 2 && fila.first != 4); // Edad vacía
+
+    const char* operadores[] = {"=", "!=", "<", "<=", ">", ">="};
+    const char* valores[] = {"3", "3.0", "0", "6", "x", "abc", "zz", "", "25", "40", "n/a", "-1", "100"};
+    long podados = 0;
+    for (const char* columna : {"k", "age"}) {
+        for (const char* op : operadores) {
+            for (const char* v : valores) {
+                int leidosZ, descartadosZ, leidosT, descartadosT;
+                auto conZonas = disco->escanearPorValor(columna, op, v, leidosZ, descartadosZ);
+                auto sinZonas = disco->escanearPorValor(columna, op, v, leidosT, descartadosT, false);
+                verificar(conZonas == sinZonas, string("scan ") + columna + " " + op + " '" + v + "': " +
+                          aTexto(conZonas) + " con zonas vs " + aTexto(sinZonas) + " sin zonas", __LINE__);
+                podados += descartadosZ;
+            }
+        }
+    }
+    VERIFICAR(podados > 0); // La poda se ejercitó
+
+    // Los zone maps persistidos dan el mismo resultado al reabrir
+    auto antes = disco->escanearPorValor("k", "=", "3", leidos, descartados);
+    delete disco;
+    disco = Disco::cargarDisco("./zonas_disk", true);
+    VERIFICAR(disco != nullptr);
+    if (disco) {
+        VERIFICAR(disco->escanearPorValor("k", "=", "3", leidos, descartados) == antes);
+        delete disco;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Compresión por diccionario: "@indice", escape de la marca "@@" y diccionario de
+// valores recargado desde Sector1 al reabrir (user-026)
+// ---------------------------------------------------------------------------
+// Contenido de los sectores de datos (sin Sector0 ni Sector1, que guardan metadatos)
+static string contenidoDatos(const string& rutaDisco) {
+    string contenido;
+    for (const auto& archivo : fs::recursive_directory_iterator(rutaDisco + "/P0")) {
+        string ruta = archivo.path().generic_string();
+        if (!archivo.is_regular_file() || ruta.find("/S0/Track0/Sector0.txt") != string::npos ||
+            ruta.find("/S0/Track0/Sector1.txt") != string::npos) {
+            continue;
+        }
+        ifstream entrada(ruta);
+        contenido += string(istreambuf_iterator<char>(entrada), istreambuf_iterator<char>());
+    }
+    return contenido;
+}
+
+static void pruebaCompresion() {
+    stringstream csv;
+    csv << "id,estado,ciudad\n";
+    const char* ciudades[] = {"Arequipa", "Cusco", "Trujillo"};
+    for (int i = 1; i <= 60; ++i) csv << i << "," << (i % 3 == 0 ? "inactivo" : "activo") << "," << ciudades[i % 3] << "\n";
+    escribirArchivo("personas.csv", csv.str());
+
+    Disco* disco = crearDisco("compr", 1, 1, 4, 8, 256, COMPRESION_DICCIONARIO);
+    VERIFICAR(disco->cargarCSV("personas.csv"));
+    // Campos que empiezan con la marca: se escapan y no se confunden con un índice
+    vector<string> especiales = {"61#@yes#no", "62#@@#@7", "63#@#inactivo", "64#activo#@0"};
+    for (const string& registro : especiales) VERIFICAR(disco->insertarRegistro(registro));
+    for (int i = 0; i < (int)especiales.size(); ++i) VERIFICAR_IGUAL(disco->recuperarRegistro(61 + i), especiales[i]);
+
+    string datos = contenidoDatos("./compr_disk");
+    VERIFICAR(datos.find("inactivo") == string::npos); // Codificado como "@indice"
+    VERIFICAR(datos.find("Arequipa") == string::npos);
+    VERIFICAR(datos.find("61#@@yes#no") != string::npos);
+    VERIFICAR(datos.find("62#@@@#@@7") != string::npos);
+    VERIFICAR(datos.find("64#@") != string::npos && datos.find("#@@0") != string::npos);
+
+    int leidos, descartados;
+    auto inactivos = disco->escanearPorValor("estado", "=", "inactivo", leidos, descartados);
+    delete disco;
+
+    // Al reabrir, el diccionario de valores se recarga desde Sector1
+    disco = Disco::cargarDisco("./compr_disk", true);
+    VERIFICAR(disco != nullptr);
+    if (disco) {
+        VERIFICAR_IGUAL(disco->getNumRegistros(), 64L);
+        VERIFICAR_IGUAL(disco->recuperarRegistro(3), string("3#inactivo#Arequipa"));
+        for (int i = 0; i < (int)especiales.size(); ++i) VERIFICAR_IGUAL(disco->recuperarRegistro(61 + i), especiales[i]);
+
+        // Los scans comparan valores decodificados, con y sin poda por zone maps
+        auto reabiertos = disco->escanearPorValor("estado", "=", "inactivo", leidos, descartados);
+        VERIFICAR(reabiertos == inactivos);
+        VERIFICAR_IGUAL((long)reabiertos.size(), 20L); // En el registro 63 "inactivo" es la ciudad
+        for (const char* valor : {"@7", "@0", "@@", "@", "Cusco"}) {
+            for (const char* columna : {"estado", "ciudad"}) {
+                int leidosT, descartadosT;
+                auto conZonas = disco->escanearPorValor(columna, "=", valor, leidos, descartados);
+                auto sinZonas = disco->escanearPorValor(columna, "=", valor, leidosT, descartadosT, false);
+                verificar(conZonas == sinZonas, string("scan ") + columna + " = '" + valor + "'", __LINE__);
+            }
+        }
+        auto arroba7 = disco->escanearPorValor("ciudad", "=", "@7", leidos, descartados);
+        VERIFICAR(arroba7.size() == 1 && arroba7[0].first == 62 && arroba7[0].second == "62#@@#@7");
+        auto arroba0 = disco->escanearPorValor("ciudad", "=", "@0", leidos, descartados);
+        VERIFICAR(arroba0.size() == 1 && arroba0[0].first == 64);
+        VERIFICAR_IGUAL((long)disco->escanearPorValor("ciudad", "=", "Cusco", leidos, descartados).size(), 20L);
+        delete disco;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Modo por lotes: un comando fallido (incluida una carga) da código de salida 1 (user-030)
+// ---------------------------------------------------------------------------
+static void pruebaLotes() {
+    escribirArchivo("datos.csv", "id,nombre\n1,ana\n2,luis\n");
+    {
+        stringstream salida;
+        InterpreteComandos interprete(salida, true);
+        interprete.ejecutar("create lotes 1 1 4 4 256");
+        interprete.ejecutar("load datos.csv");
+        interprete.ejecutar("get 2");
+        VERIFICAR_IGUAL(interprete.codigoSalida(), 0);
+        VERIFICAR(salida.str().find("2\t2#luis") != string::npos);
+    }
+    {
+        stringstream salida;
+        InterpreteComandos interprete(salida, true);
+        interprete.ejecutar("open ./lotes_disk");
+        interprete.ejecutar("load no_existe.csv");
+        VERIFICAR_IGUAL(interprete.getErrores(), 1L);
+        VERIFICAR_IGUAL(interprete.codigoSalida(), 1);
+    }
+    {
+        stringstream salida;
+        InterpreteComandos interprete(salida, true);
+        interprete.ejecutar("open ./lotes_disk");
+        escribirArchivo("otro_esquema.csv", "a,b,c\n1,2,3\n");
+        interprete.ejecutar("load otro_esquema.csv datos"); // Esquema distinto al de la tabla
+        interprete.ejecutar("get 99");
+        interprete.ejecutar("comando_inexistente");
+        VERIFICAR_IGUAL(interprete.getErrores(), 3L);
+        VERIFICAR_IGUAL(interprete.codigoSalida(), 1);
+    }
+    // La carga persiste el diccionario: los registros siguen al reabrir
+    Disco* disco = Disco::cargarDisco("./lotes_disk", true);
+    VERIFICAR(disco != nullptr);
+    if (disco) {
+        VERIFICAR_IGUAL(disco->getNumRegistros(), 2L);
+        VERIFICAR_IGUAL(disco->recuperarRegistro(1), string("1#ana"));
+        delete disco;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Escrituras fallidas: no quedan fragmentos huérfanos en los sectores (user-031)
+// ---------------------------------------------------------------------------
+// Un enlace simbólico roto hace que el sector parezca vacío pero que escribirlo falle
+static void romperSector(const string& ruta) {
+    fs::remove(ruta);
+    fs::create_symlink("/megatron_no_existe/sector", ruta);
+}
+
+static void pruebaFragmentos() {
+    escribirArchivo("uno.csv", "id,v\n1,hola\n");
+    Disco* disco = crearDisco("frag", 1, 1, 2, 4, 64);
+    disco->cargarCSV("uno.csv");
+
+    // 150 bytes no caben en el cilindro 0: van a los sectores 0, 1 y 2 de la pista 1
+    string grande = "2#" + string(150, 'A');
+    romperSector("./frag_disk/P0/S0/Track1/Sector2.txt");
+    VERIFICAR(!disco->insertarRegistro(grande));
+    VERIFICAR_IGUAL(disco->getNumRegistros(), 1L);
+    VERIFICAR_IGUAL(fs::file_size("./frag_disk/P0/S0/Track1/Sector0.txt"), (uintmax_t)0);
+    VERIFICAR_IGUAL(fs::file_size("./frag_disk/P0/S0/Track1/Sector1.txt"), (uintmax_t)0);
+    VERIFICAR(disco->verificarDisco(false, false, 1).consistente());
+
+    fs::remove("./frag_disk/P0/S0/Track1/Sector2.txt");
+    VERIFICAR(disco->insertarRegistro(grande));
+    VERIFICAR_IGUAL(disco->recuperarRegistro(2), grande);
+    VERIFICAR(disco->verificarDisco(false, false, 1).consistente());
+    delete disco;
+
+    // Carga ordenada: los registros del sector que no se pudo escribir no se dan de alta
+    stringstream csv;
+    csv << "id,v\n";
+    for (int i = 1; i <= 12; ++i) csv << i << "," << (i == 5 ? string(100, 'B') : "valor" + to_string(i)) << "\n";
+    escribirArchivo("orden.csv", csv.str());
+    disco = crearDisco("orden", 1, 1, 2, 4, 64);
+    romperSector("./orden_disk/P0/S0/Track1/Sector1.txt");
+    VERIFICAR(!disco->cargarCSVOrdenado("orden.csv", "id"));
+    // Solo quedan los registros anteriores al sector fallido, sin huecos en los IDs
+    long cargados = disco->getNumRegistros();
+    VERIFICAR(cargados > 0 && cargados < 12);
+    for (long id = 1; id <= cargados; ++id) {
+        VERIFICAR_IGUAL(disco->recuperarRegistro(id), to_string(id) + "#" + (id == 5 ? string(100, 'B') : "valor" + to_string(id)));
+    }
+    VERIFICAR(disco->verificarDisco(false, false, 1).consistente());
+    delete disco;
+
+    // Igual con registros de un solo sector: el que provocó la escritura fallida tampoco
+    // pasa al sector siguiente
+    stringstream cortos;
+    cortos << "id,v\n";
+    for (int i = 1; i <= 30; ++i) cortos << i << ",valor" << i << "\n";
+    escribirArchivo("cortos.csv", cortos.str());
+    disco = crearDisco("cortos", 1, 1, 2, 4, 64);
+    romperSector("./cortos_disk/P0/S0/Track1/Sector1.txt");
+    VERIFICAR(!disco->cargarCSVOrdenado("cortos.csv", "id"));
+    cargados = disco->getNumRegistros();
+    VERIFICAR(cargados > 0 && cargados < 30);
+    for (long id = 1; id <= cargados; ++id) VERIFICAR_IGUAL(disco->recuperarRegistro(id), to_string(id) + "#valor" + to_string(id));
+    VERIFICAR(disco->verificarDisco(false, false, 1).consistente());
+    delete disco;
+}
+
+// ---------------------------------------------------------------------------
+// fsck: los registros repartidos en varios sectores se rearman a partir de los sectores
+// aunque se pierdan sus líneas R# de Sector1 o el diccionario completo (user-036)
+// ---------------------------------------------------------------------------
+static string leerArchivo(const string& ruta) {
+    ifstream archivo(ruta);
+    stringstream contenido;
+    contenido << archivo.rdbuf();
+    return contenido.str();
+}
+
+// Deja en Sector1 solo la línea CONFIG (como tras una caída que lo dejó a medio escribir)
+static void perderMetadatos(const string& rutaDisco) {
+    string sector1 = rutaDisco + "/P0/S0/Track0/Sector1.txt";
+    string contenido = leerArchivo(sector1);
+    escribirArchivo(sector1, contenido.substr(0, contenido.find('\n') + 1));
+}
+
+static void pruebaFsck() {
+    escribirArchivo("filas.csv", "id,v,n\n1,a,10\n2,b,20\n3,c,30\n4,d,40\n");
+    string grande = "5#" + string(150, 'A') + "#50";
+    vector<string> esperados = {"1#a#10", "2#b#20", "3#c#30", "4#d#40", grande};
+
+    // Sector1 perdido: los metadatos de los desbordados están en sus propios shards
+    Disco* disco = crearDisco("fsck", 1, 1, 2, 4, 64);
+    VERIFICAR(disco->cargarCSV("filas.csv"));
+    VERIFICAR(disco->insertarRegistro(grande));
+    VERIFICAR_IGUAL(disco->recuperarRegistro(5), grande);
+    VERIFICAR(disco->verificarDisco(false, false, 1).consistente());
+    delete disco;
+    perderMetadatos("./fsck_disk");
+    disco = Disco::cargarDisco("./fsck_disk", true);
+    VERIFICAR(disco != nullptr);
+    if (disco) {
+        InformeVerificacion inf = disco->verificarDisco(true, true, 1);
+        VERIFICAR_IGUAL(inf.registrosReencadenados, 0L);
+        VERIFICAR_IGUAL(inf.registrosRecuperados, 0L);
+        VERIFICAR_IGUAL(disco->getNumRegistros(), 5L);
+        for (long id = 1; id <= 5; ++id) VERIFICAR_IGUAL(disco->recuperarRegistro(id), esperados[id - 1]);
+        VERIFICAR(disco->verificarDisco(false, false, 1).consistente());
+        delete disco;
+    }
+
+    // Shards de desbordados perdidos: la entrada del shard conserva el primer fragmento y el ID
+    fs::remove("./fsck_disk/diccionario/T0_D0.bin");
+    fs::remove("./fsck_disk/diccionario/T0_F0.bin");
+    disco = Disco::cargarDisco("./fsck_disk", true);
+    VERIFICAR(disco != nullptr);
+    if (disco) {
+        VERIFICAR_IGUAL(disco->recuperarRegistro(5), string());
+        InformeVerificacion inf = disco->verificarDisco(true, true, 1);
+        VERIFICAR_IGUAL(inf.registrosReencadenados, 1L);
+        VERIFICAR_IGUAL(inf.registrosRecuperados, 0L);
+        VERIFICAR_IGUAL(disco->getNumRegistros(), 5L);
+        for (long id = 1; id <= 5; ++id) VERIFICAR_IGUAL(disco->recuperarRegistro(id), esperados[id - 1]);
+        VERIFICAR(disco->verificarDisco(false, false, 1).consistente());
+        delete disco;
+    }
+
+    // Diccionario completo perdido: el registro repartido se da de alta entero, y sus
+    // fragmentos de continuación nunca como registros propios
+    disco = Disco::cargarDisco("./fsck_disk", true);
+    if (disco) {
+        delete disco;
+        fs::remove_all("./fsck_disk/diccionario");
+        perderMetadatos("./fsck_disk");
+        disco = Disco::cargarDisco("./fsck_disk", true);
+    }
+    VERIFICAR(disco != nullptr);
+    if (disco) {
+        InformeVerificacion inf = disco->verificarDisco(true, true, 1);
+        VERIFICAR_IGUAL(inf.registrosRecuperados, 5L);
+        VERIFICAR_IGUAL(inf.registrosReencadenados, 1L);
+        VERIFICAR_IGUAL(disco->getNumRegistros(), 5L);
+        vector<string> recuperados;
+        for (long id = 1; id <= 5; ++id) recuperados.push_back(disco->recuperarRegistro(id));
+        sort(recuperados.begin(), recuperados.end());
+        VERIFICAR(recuperados == esperados);
+        VERIFICAR(disco->verificarDisco(false, false, 1).consistente());
+        delete disco;
+    }
+
+    // Un registro repartido eliminado no deja fragmentos huérfanos
+    disco = crearDisco("baja", 1, 1, 2, 4, 64);
+    VERIFICAR(disco->cargarCSV("filas.csv"));
+    VERIFICAR(disco->insertarRegistro(grande));
+    VERIFICAR(disco->eliminarRegistro(5));
+    InformeVerificacion inf = disco->verificarDisco(false, false, 1);
+    VERIFICAR_IGUAL(inf.registrosSinEntrada, 0L);
+    VERIFICAR(inf.consistente());
+    delete disco;
+
+    // Cadena incompleta (falta el último fragmento): no se recupera ninguna de sus partes
+    disco = crearDisco("rota", 1, 1, 2, 4, 64);
+    VERIFICAR(disco->cargarCSV("filas.csv"));
+    VERIFICAR(disco->insertarRegistro(grande));
+    delete disco;
+    fs::remove_all("./rota_disk/diccionario");
+    perderMetadatos("./rota_disk");
+    escribirArchivo("./rota_disk/P0/S0/Track1/Sector2.txt", "");
+    disco = Disco::cargarDisco("./rota_disk", true);
+    VERIFICAR(disco != nullptr);
+    if (disco) {
+        InformeVerificacion inf = disco->verificarDisco(true, true, 1);
+        VERIFICAR_IGUAL(inf.cadenasIncompletas, 1L);
+        VERIFICAR_IGUAL(disco->getNumRegistros(), 4L);
+        for (long id = 1; id <= 4; ++id) VERIFICAR_IGUAL(disco->recuperarRegistro(id), esperados[id - 1]);
+        delete disco;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Recorridos por lotes de un shard: tablas de varios shards se leen completas (user-035)
+// ---------------------------------------------------------------------------
+static void pruebaShards() {
+    const long filas = 2 * ENTRADAS_POR_SHARD + 100;
+    stringstream csv;
+    csv << "id,grupo\n";
+    for (long i = 1; i <= filas; ++i) csv << i << "," << i % 10 << "\n";
+    escribirArchivo("grande.csv", csv.str());
+
+    Disco* disco = crearDisco("shards", 2, 2, 16, 16, 1024);
+    VERIFICAR(disco->cargarCSV("grande.csv"));
+    int leidos, descartados;
+    auto todos = disco->escanearPorValor("id", ">=", "1", leidos, descartados);
+    VERIFICAR_IGUAL((long)todos.size(), filas);
+    bool enOrden = true;
+    for (long i = 0; i < (long)todos.size(); ++i) enOrden = enOrden && todos[i].first == i + 1 && todos[i].second == to_string(i + 1) + "#" + to_string((i + 1) % 10);
+    VERIFICAR(enOrden);
+    auto grupo = disco->escanearPorValor("grupo", "=", "7", leidos, descartados);
+    VERIFICAR_IGUAL((long)grupo.size(), filas / 10);
+    delete disco;
+
+    // Los shards sincronizados se leen igual al reabrir
+    disco = Disco::cargarDisco("./shards_disk", true);
+    VERIFICAR(disco != nullptr);
+    if (disco) {
+        VERIFICAR(disco->escanearPorValor("grupo", "=", "7", leidos, descartados) == grupo);
+        // Con memoria para un solo shard se desalojan los demás y el recorrido no cambia
+        const size_t unShard = ENTRADAS_POR_SHARD * sizeof(EntradaDiccionario);
+        disco->setMemoriaShards(unShard);
+        VERIFICAR(disco->getMemoriaShardsResidente() <= unShard);
+        VERIFICAR(disco->escanearPorValor("id", ">=", "1", leidos, descartados) == todos);
+        VERIFICAR(disco->getMemoriaShardsResidente() <= unShard);
+        VERIFICAR_IGUAL(disco->recuperarRegistro(1), string("1#1"));
+        VERIFICAR_IGUAL(disco->recuperarRegistro(filas), to_string(filas) + "#" + to_string(filas % 10));
+        VERIFICAR(disco->getMemoriaShardsResidente() <= unShard);
+        delete disco;
+    }
+
+    // Filas más anchas que un sector: todas desbordan y sus metadatos van a los shards
+    // _D/_F, no a Sector1
+    const long anchas = 300;
+    stringstream csvAnchas;
+    csvAnchas << "id,texto\n";
+    for (long i = 1; i <= anchas; ++i) csvAnchas << i << "," << string(110, 'a' + i % 26) << "\n";
+    escribirArchivo("anchas.csv", csvAnchas.str());
+    disco = crearDisco("anchas", 1, 2, 16, 64, 64);
+    VERIFICAR(disco->cargarCSV("anchas.csv"));
+    delete disco;
+    VERIFICAR(leerArchivo("./anchas_disk/P0/S0/Track0/Sector1.txt").find("\nR#") == string::npos);
+    VERIFICAR(fs::exists("./anchas_disk/diccionario/T0_D0.bin"));
+    disco = Disco::cargarDisco("./anchas_disk", true);
+    VERIFICAR(disco != nullptr);
+    if (disco) {
+        VERIFICAR_IGUAL(disco->getNumRegistros(), anchas);
+        auto filasAnchas = disco->escanearPorValor("id", ">=", "1", leidos, descartados);
+        bool completas = (long)filasAnchas.size() == anchas;
+        for (long i = 0; completas && i < anchas; ++i) {
+            completas = filasAnchas[i].second == to_string(i + 1) + "#" + string(110, 'a' + (i + 1) % 26);
+        }
+        VERIFICAR(completas);
+        VERIFICAR(disco->verificarDisco(false, false, 1).consistente());
+        delete disco;
+    }
+
+    // Disco anterior: el registro desbordado está como línea R en Sector1 y se migra a los
+    // shards al abrir
+    escribirArchivo("pocas.csv", "id,v\n1,a\n2,b\n");
+    disco = crearDisco("legado", 1, 1, 2, 4, 64);
+    VERIFICAR(disco->cargarCSV("pocas.csv"));
+    delete disco;
+    escribirArchivo("./legado_disk/P0/S0/Track1/Sector0.txt", "3#" + string(50, 'x') + "\n");
+    escribirArchivo("./legado_disk/P0/S0/Track1/Sector1.txt", string(40, 'x') + "#fin\n");
+    string sector1 = leerArchivo("./legado_disk/P0/S0/Track0/Sector1.txt");
+    size_t tabla = sector1.find("TABLA#0#3#2");
+    VERIFICAR(tabla != string::npos);
+    if (tabla != string::npos) {
+        sector1.replace(tabla, 11, "TABLA#0#4#3");
+        escribirArchivo("./legado_disk/P0/S0/Track0/Sector1.txt", sector1 + "R#3#0#0#1#0#0#53#1#0:0:1:1:0:45\n");
+    }
+    disco = Disco::cargarDisco("./legado_disk", true);
+    VERIFICAR(disco != nullptr);
+    if (disco) {
+        VERIFICAR_IGUAL(disco->recuperarRegistro(3), "3#" + string(90, 'x') + "#fin");
+        delete disco;
+    }
+    VERIFICAR(leerArchivo("./legado_disk/P0/S0/Track0/Sector1.txt").find("\nR#") == string::npos);
+    disco = Disco::cargarDisco("./legado_disk", true);
+    if (disco) {
+        VERIFICAR_IGUAL(disco->getNumRegistros(), 3L);
+        VERIFICAR_IGUAL(disco->recuperarRegistro(3), "3#" + string(90, 'x') + "#fin");
+        delete disco;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Join: hash, grace hash y sort-merge dan el mismo resultado dentro del presupuesto de
+// memoria (user-034)
+// ---------------------------------------------------------------------------
+typedef vector<pair<string, string>> FilasCSV; // (clave, registro con '#')
+
+static FilasCSV escribirTablaCSV(const string& ruta, const string& esquema, int filas, int columnaClave,
+                                 const function<string(int)>& clave, const function<string(int)>& relleno) {
+    FilasCSV datos;
+    stringstream csv;
+    csv << esquema << "\n";
+    for (int i = 1; i <= filas; ++i) {
+        string k = clave(i);
+        vector<string> campos = {to_string(i), relleno(i)};
+        campos.insert(campos.begin() + columnaClave, k);
+        string registro = campos[0] + "#" + campos[1] + "#" + campos[2];
+        csv << campos[0] << "," << campos[1] << "," << campos[2] << "\n";
+        datos.push_back({k, registro});
+    }
+    escribirArchivo(ruta, csv.str());
+    return datos;
+}
+
+// Resultado esperado: producto de las filas con claves no vacías iguales (por valor)
+static vector<string> joinEsperado(const FilasCSV& izq, const FilasCSV& der) {
+    unordered_multimap<string, string> derecha;
+    for (const auto& fila : der) {
+        if (!fila.first.empty()) derecha.emplace(claveIgualdad(fila.first), fila.second);
+    }
+    vector<string> filas;
+    for (const auto& fila : izq) {
+        if (fila.first.empty()) continue;
+        auto rango = derecha.equal_range(claveIgualdad(fila.first));
+        for (auto it = rango.first; it != rango.second; ++it) filas.push_back(fila.second + "#" + it->second);
+    }
+    sort(filas.begin(), filas.end());
+    return filas;
+}
+
+static void pruebaJoin() {
+    // Claves con duplicados, vacíos y números escritos de distinta forma ("3" y "3.0")
+    FilasCSV pedidos = escribirTablaCSV("pedidos.csv", "id,cliente,monto", 3000, 1,
+        [](int i) { return i % 97 == 0 ? string("") : (i % 5 == 0 ? to_string(i % 400) + ".0" : to_string(i % 400)); },
+        [](int i) { return to_string((i * 37) % 1000); });
+    FilasCSV clientes = escribirTablaCSV("clientes.csv", "cid,nombre,ciudad", 500, 0,
+        [](int i) { return i % 50 == 0 ? string("") : to_string(i % 450); },
+        [](int i) { return "cliente" + to_string(i); });
+    vector<string> esperado = joinEsperado(pedidos, clientes);
+    VERIFICAR(esperado.size() > 3000);
+
+    Disco* disco = crearDisco("join", 2, 2, 16, 16, 2048);
+    VERIFICAR(disco->cargarCSV("pedidos.csv"));                             // Sin agrupar por cliente
+    VERIFICAR(disco->cargarCSVOrdenado("clientes.csv", "nombre", "clientes")); // Agrupada por otra columna
+    VERIFICAR(disco->cargarCSVOrdenado("pedidos.csv", "cliente", "pedidos_ord"));
+    VERIFICAR(disco->cargarCSVOrdenado("clientes.csv", "cid", "clientes_ord"));
+
+    struct Caso {
+        string izq, der, algoritmo;
+        size_t memoria;
+        int hilos;
+    };
+    const size_t MUCHA = 64 * 1024 * 1024, POCA = 12 * 1024;
+    vector<Caso> casos;
+    for (int hilos : {1, 4}) {
+        for (const char* izq : {"pedidos", "pedidos_ord"}) {
+            for (const char* der : {"clientes", "clientes_ord"}) {
+                for (const char* algoritmo : {"hash", "merge"}) {
+                    casos.push_back({izq, der, algoritmo, MUCHA, hilos});
+                    casos.push_back({izq, der, algoritmo, POCA, hilos});
+                }
+            }
+        }
+    }
+    for (const Caso& caso : casos) {
+        vector<string> filas;
+        EstadisticasJoin est = disco->unirTablas(caso.izq, caso.izq[0] == 'p' ? "cliente" : "cid",
+                                                 caso.der, "cid", caso.algoritmo,
+                                                 [&](const string& fila) { filas.push_back(fila); }, caso.memoria, caso.hilos);
+        sort(filas.begin(), filas.end());
+        string descripcion = caso.algoritmo + " " + caso.izq + "/" + caso.der + " memoria " + to_string(caso.memoria) +
+                             " hilos " + to_string(caso.hilos);
+        verificar(est.ok && filas == esperado, descripcion + ": " + to_string(filas.size()) + " filas vs " +
+                  to_string(esperado.size()), __LINE__);
+        verificar(est.filas == (long)filas.size(), descripcion + ": est.filas", __LINE__);
+        verificar(est.memoriaMaxima <= caso.memoria, descripcion + ": memoria máxima " + to_string(est.memoriaMaxima), __LINE__);
+        if (caso.algoritmo == "hash" && caso.memoria == POCA) verificar(est.derramado, descripcion + ": grace", __LINE__);
+        if (caso.algoritmo == "merge") {
+            bool ordenadas = caso.izq == "pedidos_ord" && caso.der == "clientes_ord";
+            verificar(est.entradaOrdenada == !ordenadas, descripcion + ": entradaOrdenada", __LINE__);
+            if (!ordenadas && caso.memoria == POCA) verificar(est.derramado, descripcion + ": corridas en disco", __LINE__);
+        }
+    }
+
+    // Con 64 particiones de primer nivel todavía demasiado grandes, se vuelven a dividir
+    FilasCSV grande = escribirTablaCSV("grande.csv", "id,k,v", 20000, 1,
+        [](int i) { return to_string(i % 5000); }, [](int i) { return "v" + to_string(i); });
+    VERIFICAR(disco->cargarCSV("grande.csv"));
+    VERIFICAR(disco->cargarCSV("grande.csv", "grande2"));
+    vector<string> esperadoGrande = joinEsperado(grande, grande);
+    {
+        vector<string> filas;
+        EstadisticasJoin est = disco->unirTablas("grande", "k", "grande2", "k", "hash",
+                                                 [&](const string& fila) { filas.push_back(fila); }, 8 * 1024, 2);
+        sort(filas.begin(), filas.end());
+        VERIFICAR(filas == esperadoGrande);
+        VERIFICAR(est.reparticiones > 0);
+        VERIFICAR(est.memoriaMaxima <= 8 * 1024);
+    }
+
+    // Una clave muy repetida no se puede repartir: el grace hash join une la partición por
+    // bloques y el sort-merge lleva el grupo a disco
+    FilasCSV repetidos = escribirTablaCSV("repetidos.csv", "id,k,v", 800, 1,
+        [](int i) { return i % 8 == 0 ? to_string(i) : string("7"); }, [](int i) { return "valor" + to_string(i); });
+    FilasCSV otros = escribirTablaCSV("otros.csv", "id,k,v", 900, 1,
+        [](int i) { return i % 3 == 0 ? string("7") : to_string(i); }, [](int i) { return "otro" + to_string(i); });
+    VERIFICAR(disco->cargarCSV("repetidos.csv"));
+    VERIFICAR(disco->cargarCSV("otros.csv"));
+    vector<string> esperadoRepetidos = joinEsperado(repetidos, otros);
+    for (const char* algoritmo : {"hash", "merge"}) {
+        for (int hilos : {1, 3}) {
+            vector<string> filas;
+            EstadisticasJoin est = disco->unirTablas("repetidos", "k", "otros", "k", algoritmo,
+                                                     [&](const string& fila) { filas.push_back(fila); }, 16 * 1024, hilos);
+            sort(filas.begin(), filas.end());
+            VERIFICAR(filas == esperadoRepetidos);
+            VERIFICAR(est.memoriaMaxima <= 16 * 1024);
+            VERIFICAR(est.derramado);
+        }
+    }
+    delete disco;
+}
+
+// ---------------------------------------------------------------------------
+// Catálogo de varias tablas: líneas T#/E# de Sector0, sectores y filas de cada tabla
+// separados al reabrir, y shards de un ID reutilizado descartados (user-032)
+// ---------------------------------------------------------------------------
+// Sectores asignados a cada tabla según las líneas E# del catálogo
+static unordered_map<int, long> sectoresPorTabla(const string& sector0) {
+    unordered_map<int, long> sectores;
+    stringstream ss(sector0);
+    string linea;
+    while (getline(ss, linea)) {
+        if (linea.rfind("E#", 0) != 0) continue;
+        vector<string> campos = dividirCampos(linea);
+        if (campos.size() == 4) sectores[stoi(campos[1])] += stol(campos[3]);
+    }
+    return sectores;
+}
+
+static void pruebaCatalogo() {
+    stringstream clientes, pedidos;
+    clientes << "id,nombre\n";
+    for (int i = 1; i <= 30; ++i) clientes << i << ",cliente" << i << "\n";
+    pedidos << "id,monto\n";
+    for (int i = 1; i <= 20; ++i) pedidos << i << "," << i * 100 << "\n";
+    escribirArchivo("clientes.csv", clientes.str());
+    escribirArchivo("pedidos.csv", pedidos.str());
+
+    Disco* disco = crearDisco("catalogo", 1, 1, 4, 8, 128);
+    VERIFICAR(disco->cargarCSV("clientes.csv"));
+    VERIFICAR(disco->cargarCSV("pedidos.csv"));
+    delete disco;
+
+    const string rutaSector0 = "./catalogo_disk/P0/S0/Track0/Sector0.txt";
+    string sector0 = leerArchivo(rutaSector0);
+    VERIFICAR(sector0.find("T#0#clientes#id#nombre\n") != string::npos);
+    VERIFICAR(sector0.find("T#1#pedidos#id#monto\n") != string::npos);
+    unordered_map<int, long> sectores = sectoresPorTabla(sector0);
+    VERIFICAR_IGUAL(sectores.size(), (size_t)2);
+    VERIFICAR(sectores[0] > 0 && sectores[1] > 0);
+
+    // Al reabrir, cada tabla conserva sus sectores y solo ve sus propias filas
+    disco = Disco::cargarDisco("./catalogo_disk", true);
+    VERIFICAR(disco != nullptr);
+    if (!disco) return;
+    stringstream listado;
+    disco->listarTablas(listado);
+    VERIFICAR(listado.str().find("clientes (id 0): 30 registros, " + to_string(sectores[0]) + " sectores") != string::npos);
+    VERIFICAR(listado.str().find("pedidos (id 1): 20 registros, " + to_string(sectores[1]) + " sectores") != string::npos);
+    int leidos, descartados;
+    VERIFICAR(disco->seleccionarTabla("clientes"));
+    VERIFICAR_IGUAL(disco->getNumRegistros(), 30L);
+    VERIFICAR_IGUAL(disco->recuperarRegistro(25), string("25#cliente25"));
+    auto filasClientes = disco->escanearPorValor("id", ">=", "1", leidos, descartados);
+    bool soloClientes = filasClientes.size() == 30;
+    for (size_t i = 0; soloClientes && i < filasClientes.size(); ++i) {
+        soloClientes = filasClientes[i].second == to_string(i + 1) + "#cliente" + to_string(i + 1);
+    }
+    VERIFICAR(soloClientes);
+    VERIFICAR(disco->seleccionarTabla("pedidos"));
+    VERIFICAR_IGUAL(disco->getNumRegistros(), 20L);
+    VERIFICAR_IGUAL(disco->recuperarRegistro(5), string("5#500"));
+    VERIFICAR(disco->recuperarRegistro(25).empty());
+    auto filasPedidos = disco->escanearPorValor("id", ">=", "1", leidos, descartados);
+    bool soloPedidos = filasPedidos.size() == 20;
+    for (size_t i = 0; soloPedidos && i < filasPedidos.size(); ++i) {
+        soloPedidos = filasPedidos[i].second == to_string(i + 1) + "#" + to_string((i + 1) * 100);
+    }
+    VERIFICAR(soloPedidos);
+    VERIFICAR(!disco->seleccionarTabla("facturas"));
+    VERIFICAR(disco->verificarDisco(false, false, 1).consistente());
+    delete disco;
+
+    // Si la tabla 1 desaparece del catálogo y de Sector1 (solo quedan sus shards), una tabla
+    // nueva reutiliza su ID: los shards que quedaron se descartan y no ve las filas anteriores
+    auto sinTabla1 = [](const string& contenido) {
+        string resultado;
+        stringstream lineas(contenido);
+        string linea;
+        while (getline(lineas, linea)) {
+            if (linea.rfind("T#1#", 0) != 0 && linea.rfind("E#1#", 0) != 0 && linea.rfind("TABLA#1#", 0) != 0) {
+                resultado += linea + "\n";
+            }
+        }
+        return resultado;
+    };
+    const string rutaSector1 = "./catalogo_disk/P0/S0/Track0/Sector1.txt";
+    escribirArchivo(rutaSector0, sinTabla1(sector0));
+    escribirArchivo(rutaSector1, sinTabla1(leerArchivo(rutaSector1)));
+    VERIFICAR(fs::exists("./catalogo_disk/diccionario/T1_S0.bin"));
+    escribirArchivo("ventas.csv", "id,total\n1,7\n2,8\n3,9\n");
+    disco = Disco::cargarDisco("./catalogo_disk", true);
+    VERIFICAR(disco != nullptr);
+    if (!disco) return;
+    VERIFICAR(disco->cargarCSV("ventas.csv"));
+    VERIFICAR(leerArchivo(rutaSector0).find("T#1#ventas#id#total\n") != string::npos);
+    VERIFICAR_IGUAL(disco->getNumRegistros(), 3L);
+    VERIFICAR_IGUAL(disco->recuperarRegistro(2), string("2#8"));
+    VERIFICAR(disco->recuperarRegistro(5).empty());
+    VERIFICAR_IGUAL(disco->escanearPorValor("id", ">=", "1", leidos, descartados).size(), (size_t)3);
+    // fsck recorre también los shards posteriores a siguienteId: ninguna entrada de ventas
+    // apunta a las filas de pedidos, que quedan como registros sin entrada
+    InformeVerificacion inf = disco->verificarDisco(true, false, 1);
+    VERIFICAR_IGUAL(inf.entradasFueraDeSecuencia, 0L);
+    VERIFICAR_IGUAL(inf.entradasInvalidas, 0L);
+    VERIFICAR_IGUAL(inf.registrosSinEntrada, 20L);
+    VERIFICAR_IGUAL(disco->getNumRegistros(), 3L);
+    VERIFICAR(disco->recuperarRegistro(5).empty());
+    VERIFICAR(disco->seleccionarTabla("clientes"));
+    VERIFICAR_IGUAL(disco->recuperarRegistro(25), string("25#cliente25"));
+    delete disco;
+}
+
+// ---------------------------------------------------------------------------
+// Métricas: cubetas y percentiles del histograma, y 'stats' sin métricas (user-028)
+// ---------------------------------------------------------------------------
+static void pruebaMetricas() {
+#ifndef DISCO_SIN_METRICAS
+    // Cubeta i = [2^i, 2^(i+1)) ns; 0 y 1 caen en la primera
+    VERIFICAR_IGUAL(HistogramaLatencia::cubetaPara(0), 0);
+    VERIFICAR_IGUAL(HistogramaLatencia::cubetaPara(1), 0);
+    VERIFICAR_IGUAL(HistogramaLatencia::cubetaPara(2), 1);
+    VERIFICAR_IGUAL(HistogramaLatencia::cubetaPara(1023), 9);
+    VERIFICAR_IGUAL(HistogramaLatencia::cubetaPara(1024), 10);
+    VERIFICAR_IGUAL(HistogramaLatencia::cubetaPara(~0ULL), HistogramaLatencia::NUM_CUBETAS - 1);
+
+    HistogramaLatencia vacio;
+    VERIFICAR_IGUAL(vacio.percentil(0.5), 0ULL);
+
+    // 51 de 1000 ns, 48 de 3000 ns y una de 100 us: p50 en la cubeta de 1000, p99 y p999
+    // en la última, acotados por el máximo
+    Metricas locales;
+    HistogramaLatencia& h = locales.latencias[OP_RECUPERAR];
+    for (int i = 0; i < 51; ++i) h.registrar(1000);
+    for (int i = 0; i < 48; ++i) h.registrar(3000);
+    h.registrar(100000);
+    VERIFICAR_IGUAL(h.cuenta.load(), 100ULL);
+    VERIFICAR_IGUAL(h.sumaNanos.load(), 51 * 1000ULL + 48 * 3000ULL + 100000ULL);
+    VERIFICAR_IGUAL(h.maxNanos.load(), 100000ULL);
+    VERIFICAR_IGUAL(h.cubetas[9].load(), 51ULL);
+    VERIFICAR_IGUAL(h.cubetas[11].load(), 48ULL);
+    VERIFICAR_IGUAL(h.cubetas[16].load(), 1ULL);
+    VERIFICAR_IGUAL(h.percentil(0.50), 1024ULL);
+    VERIFICAR_IGUAL(h.percentil(0.51), 4096ULL);
+    VERIFICAR_IGUAL(h.percentil(0.99), 100000ULL);
+    VERIFICAR_IGUAL(h.percentil(0.999), 100000ULL);
+
+    // Solo se listan las operaciones medidas
+    stringstream tabla;
+    locales.mostrar(tabla);
+    VERIFICAR(tabla.str().find("recuperarRegistro") != string::npos);
+    VERIFICAR(tabla.str().find("insertarRegistro") == string::npos);
+    h.reiniciar();
+    VERIFICAR_IGUAL(h.cuenta.load(), 0ULL);
+    VERIFICAR_IGUAL(h.percentil(0.99), 0ULL);
+#endif
+
+    // 'stats' muestra las métricas solo si se compilaron
+    stringstream salida;
+    {
+        InterpreteComandos interprete(salida, true);
+        interprete.ejecutar("create metricas 1 1 2 4 64");
+        interprete.ejecutar("stats");
+    }
+    bool conMetricas = salida.str().find("Métricas de Operaciones") != string::npos;
+#ifndef DISCO_SIN_METRICAS
+    VERIFICAR(conMetricas);
+#else
+    VERIFICAR(!conMetricas);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    vector<pair<string, function<void()>>> pruebas = {
+        {"zonas", pruebaZonas},
+        {"compresion", pruebaCompresion},
+        {"lotes", pruebaLotes},
+        {"fragmentos", pruebaFragmentos},
+        {"fsck", pruebaFsck},
+        {"shards", pruebaShards},
+        {"join", pruebaJoin},
+        {"catalogo", pruebaCatalogo},
+        {"metricas", pruebaMetricas},
+    };
+
+    fs::path original = fs::current_path();
+    fs::path base = fs::temp_directory_path() / ("megatron_pruebas_" + to_string(chrono::steady_clock::now().time_since_epoch().count()));
+    for (const auto& prueba : pruebas) {
+        if (argc > 1 && find(argv + 1, argv + argc, prueba.first) == argv + argc) continue;
+        pruebaActual = prueba.first;
+        fs::path directorio = base / prueba.first;
+        fs::create_directories(directorio);
+        fs::current_path(directorio);
+        long fallosAntes = fallos;
+        prueba.second();
+        fs::current_path(original);
+        fs::remove_all(directorio);
+        cout << (fallos == fallosAntes ? "OK    " : "FALLO ") << prueba.first << "\n";
+    }
+    fs::remove_all(base);
+    cout << verificaciones << " verificaciones, " << fallos << " fallos\n";
+    return fallos > 0 ? 1 : 0;
+}